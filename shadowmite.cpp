@@ -11,15 +11,445 @@
 #include <cstring>
 #include <iostream>
 #include <unordered_set>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <deque>
+#include <condition_variable>
+#include <string_view>
+#include <algorithm>
+#include <array>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include <cerrno>
 #include "json.hpp" // nlohmann::json single-header
 
 namespace fs = std::filesystem;
 using json = nlohmann::json;
 
+// ---------------- Locale entries ----------------
+struct LocaleEntry {
+    std::string name;       // e.g. en_US.UTF-8
+    std::string charmap;    // from SUPPORTED, e.g. UTF-8; empty if unknown
+    bool needs_generation;  // not yet compiled into the archive
+    std::string language;   // display names from iso-codes, or the raw codes
+    std::string territory;
+};
+
+enum class LocaleGenState { Idle, Running, Done, Failed };
+
+// Speculative single-locale `localedef` run for the current language choice
+struct LocaleGenJob {
+    GPid pid;
+    guint serial;           // bumped on every restart so stale exits are ignored
+    std::string locale;
+    LocaleGenState state;
+    bool apply_pending;     // finish page reached while the job was still running
+    gint64 started;         // monotonic, for the timing report
+    GPid draining;          // superseded localedef that is left to finish
+    bool spawn_waiting;     // this job starts once `draining` has exited
+    bool applying;          // update-locale running for `applying_lang`
+    gint64 apply_started;   // monotonic, when that update-locale started
+    std::string applying_lang;
+    std::string applied;    // last locale update-locale set successfully
+};
+
+// Timezone apply from the finish page; at most one privileged child at a time
+struct TimezoneJob {
+    bool applying;
+    std::string applying_tz;
+    int journal_step;
+    gint64 started;         // monotonic, for the timing report
+    bool apply_pending;     // choice changed while a child was running
+    std::string applied;    // last zone set successfully
+};
+
+// ---------------- App entries ----------------
+// Identifies one version of a file on disk, for cache invalidation
+struct FileStamp {
+    uint64_t mtime_ns;
+    uint64_t size;
+    uint64_t inode;
+
+    bool operator==(const FileStamp& o) const {
+        return mtime_ns == o.mtime_ns && size == o.size && inode == o.inode;
+    }
+};
+
+struct AppEntry {
+    std::string name;
+    std::string description;
+    std::string logo;
+    std::string package;
+    std::string repo;       // local .deb directory for offline installs, or empty
+    fs::path path;
+    FileStamp stamp;        // of the JSON file when it was parsed
+};
+
+// ---------------- Catalog ----------------
+// The loaded app catalog. Entries live contiguously and are addressed by id
+// (their index); every string is interned once in a block-allocated pool, so
+// shared values such as the default logo path are stored a single time.
+// Strings are refcounted by the entries using them; once the dead ones
+// outweigh the live ones the pool is rebuilt from the live entries.
+static const size_t STRING_POOL_BLOCK = 64 * 1024;
+
+struct StringPool {
+    std::vector<std::unique_ptr<char[]>> blocks;
+    std::vector<std::unique_ptr<char[]>> large;       // strings bigger than a block
+    size_t block_used;
+    std::vector<std::string_view> strings;            // id -> text, views into the blocks
+    std::vector<uint32_t> refs;                       // id -> entries using it; 0 once dead
+    std::unordered_map<std::string_view, uint32_t> ids;   // live strings only
+    size_t live_bytes;
+    size_t dead_bytes;
+};
+
+static uint32_t intern_string(StringPool& pool, std::string_view s) {
+    auto it = pool.ids.find(s);
+    if (it != pool.ids.end()) {
+        ++pool.refs[it->second];
+        return it->second;
+    }
+
+    size_t need = s.size() + 1;
+    char* dst;
+    if (need > STRING_POOL_BLOCK) {
+        pool.large.emplace_back(new char[need]);
+        dst = pool.large.back().get();
+    } else {
+        if (pool.blocks.empty() || pool.block_used + need > STRING_POOL_BLOCK) {
+            pool.blocks.emplace_back(new char[STRING_POOL_BLOCK]);
+            pool.block_used = 0;
+        }
+        dst = pool.blocks.back().get() + pool.block_used;
+        pool.block_used += need;
+    }
+    memcpy(dst, s.data(), s.size());
+    dst[s.size()] = '\0';
+
+    uint32_t id = pool.strings.size();
+    pool.strings.emplace_back(dst, s.size());
+    pool.refs.push_back(1);
+    pool.ids.emplace(pool.strings.back(), id);
+    pool.live_bytes += need;
+    return id;
+}
+
+// Drop one reference; the bytes of a dead string are reclaimed by compaction
+static void release_string(StringPool& pool, uint32_t id) {
+    if (--pool.refs[id]) return;
+    pool.ids.erase(pool.strings[id]);
+    pool.live_bytes -= pool.strings[id].size() + 1;
+    pool.dead_bytes += pool.strings[id].size() + 1;
+}
+
+struct CatalogEntry {
+    uint32_t name;          // string pool ids
+    uint32_t description;
+    uint32_t logo;
+    uint32_t package;
+    uint32_t repo;
+    uint32_t path;
+    uint32_t folded;        // lowercased "name\ndescription\npackage", for search
+    FileStamp stamp;
+    bool live;              // false for slots freed by a removal
+};
+
+struct Catalog {
+    StringPool strings;
+    std::vector<CatalogEntry> entries;                  // index == id
+    std::vector<uint32_t> free_ids;
+    std::unordered_map<std::string_view, uint32_t> by_path;
+    // Search index: every byte trigram of an entry's folded text -> sorted ids
+    std::unordered_map<uint32_t, std::vector<uint32_t>> trigrams;
+};
+
+static uint32_t trigram_key(const char* p) {
+    return (uint32_t)(unsigned char)p[0] << 16 | (uint32_t)(unsigned char)p[1] << 8 | (unsigned char)p[2];
+}
+
+static std::vector<uint32_t> trigrams_of(std::string_view text) {
+    std::vector<uint32_t> keys;
+    for (size_t i = 0; i + 3 <= text.size(); ++i) keys.push_back(trigram_key(text.data() + i));
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    return keys;
+}
+
+static void trigram_index_add(Catalog& cat, uint32_t id) {
+    for (uint32_t key : trigrams_of(cat.strings.strings[cat.entries[id].folded])) {
+        auto& ids = cat.trigrams[key];
+        ids.insert(std::lower_bound(ids.begin(), ids.end(), id), id);
+    }
+}
+
+static void trigram_index_remove(Catalog& cat, uint32_t id) {
+    for (uint32_t key : trigrams_of(cat.strings.strings[cat.entries[id].folded])) {
+        auto it = cat.trigrams.find(key);
+        if (it == cat.trigrams.end()) continue;
+        auto pos = std::lower_bound(it->second.begin(), it->second.end(), id);
+        if (pos != it->second.end() && *pos == id) it->second.erase(pos);
+        if (it->second.empty()) cat.trigrams.erase(it);
+    }
+}
+
+static const char* catalog_str(const Catalog& cat, uint32_t sid) {
+    return cat.strings.strings[sid].data();     // NUL-terminated in the pool
+}
+
+static int64_t catalog_find(const Catalog& cat, const std::string& path) {
+    auto it = cat.by_path.find(path);
+    return it == cat.by_path.end() ? -1 : (int64_t)it->second;
+}
+
+static void catalog_release(Catalog& cat, const CatalogEntry& e) {
+    for (uint32_t sid : {e.name, e.description, e.logo, e.package, e.repo, e.path, e.folded})
+        release_string(cat.strings, sid);
+}
+
+// Insert `app`, or overwrite the entry already loaded from the same file.
+// An unchanged entry leaves the path map and the search index alone.
+static uint32_t catalog_put(Catalog& cat, const AppEntry& app) {
+    CatalogEntry e;
+    e.name = intern_string(cat.strings, app.name);
+    e.description = intern_string(cat.strings, app.description);
+    e.logo = intern_string(cat.strings, app.logo);
+    e.package = intern_string(cat.strings, app.package);
+    e.repo = intern_string(cat.strings, app.repo);
+    e.path = intern_string(cat.strings, app.path.string());
+    std::string folded = app.name + "\n" + app.description + "\n" + app.package;
+    for (auto& c : folded) c = (char)tolower((unsigned char)c);
+    e.folded = intern_string(cat.strings, folded);
+    e.stamp = app.stamp;
+    e.live = true;
+
+    std::string_view path = cat.strings.strings[e.path];
+    auto it = cat.by_path.find(path);
+    uint32_t id;
+    if (it != cat.by_path.end()) {
+        id = it->second;
+        CatalogEntry& old = cat.entries[id];
+        bool same_text = old.folded == e.folded;
+        if (same_text && old.name == e.name && old.description == e.description && old.logo == e.logo &&
+            old.package == e.package && old.repo == e.repo) {
+            catalog_release(cat, e);
+            old.stamp = e.stamp;
+            return id;
+        }
+        if (!same_text) trigram_index_remove(cat, id);
+        catalog_release(cat, old);
+        old = e;
+        if (!same_text) trigram_index_add(cat, id);
+        return id;
+    } else if (!cat.free_ids.empty()) {
+        id = cat.free_ids.back();
+        cat.free_ids.pop_back();
+        cat.by_path.emplace(path, id);
+    } else {
+        id = cat.entries.size();
+        cat.entries.emplace_back();
+        cat.by_path.emplace(path, id);
+    }
+    cat.entries[id] = e;
+    trigram_index_add(cat, id);
+    return id;
+}
+
+static void catalog_erase(Catalog& cat, uint32_t id) {
+    CatalogEntry& e = cat.entries[id];
+    if (!e.live) return;
+    trigram_index_remove(cat, id);
+    cat.by_path.erase(cat.strings.strings[e.path]);
+    catalog_release(cat, e);
+    e.live = false;
+    cat.free_ids.push_back(id);
+}
+
+// Rebuild the string pool from the live entries once at least half of it
+// (and a full block) is dead. Entry ids are unchanged; string ids are not.
+static void catalog_compact(Catalog& cat) {
+    StringPool& old = cat.strings;
+    if (old.dead_bytes < STRING_POOL_BLOCK || old.dead_bytes < old.live_bytes) return;
+
+    StringPool pool{};
+    cat.by_path.clear();
+    for (uint32_t id = 0; id < cat.entries.size(); ++id) {
+        CatalogEntry& e = cat.entries[id];
+        if (!e.live) continue;
+        for (uint32_t* sid : {&e.name, &e.description, &e.logo, &e.package, &e.repo, &e.path, &e.folded})
+            *sid = intern_string(pool, old.strings[*sid]);
+        cat.by_path.emplace(pool.strings[e.path], id);
+    }
+    cat.strings = std::move(pool);
+}
+
+// Ids of live entries whose folded text contains every word of `words`.
+// Words of three or more bytes are narrowed through the trigram index using
+// their rarest trigram; the survivors are then checked directly.
+static std::vector<uint32_t> catalog_search(const Catalog& cat, const std::vector<std::string>& words) {
+    const std::vector<uint32_t>* best = nullptr;
+    for (const auto& w : words) {
+        for (size_t i = 0; i + 3 <= w.size(); ++i) {
+            auto it = cat.trigrams.find(trigram_key(w.data() + i));
+            if (it == cat.trigrams.end()) return {};
+            if (!best || it->second.size() < best->size()) best = &it->second;
+        }
+    }
+
+    std::vector<uint32_t> result;
+    auto check = [&](uint32_t id) {
+        const CatalogEntry& e = cat.entries[id];
+        if (!e.live) return;
+        std::string_view text = cat.strings.strings[e.folded];
+        for (const auto& w : words)
+            if (text.find(w) == std::string_view::npos) return;
+        result.push_back(id);
+    };
+    if (best) {
+        for (uint32_t id : *best) check(id);
+    } else {
+        for (uint32_t id = 0; id < cat.entries.size(); ++id) check(id);
+    }
+    return result;
+}
+
+// Pending list-size logo decodes; rows are referred to by catalog id and
+// logo path, so a row that is removed or edited meanwhile drops its result
+struct LogoJob {
+    uint32_t id;
+    std::string logo;
+};
+
+struct LogoResult {
+    uint32_t id;
+    std::string logo;
+    GdkPixbuf* pixbuf;
+};
+
+struct LogoQueue {
+    std::mutex mu;
+    std::condition_variable cv;
+    std::deque<LogoJob> jobs;
+    std::vector<LogoResult> done;
+    bool flush_scheduled;
+    bool worker_started;
+};
+
+// ---------------- Package installation ----------------
+enum class InstallState { Idle, Running, Done, Failed, Cancelled };
+
+// One app handed to the installer: its JSON `package` field and, for an
+// offline install, the local .deb directory it names
+struct InstallItem {
+    std::string package;
+    std::string repo;
+};
+
+// ---------------- Install journal ----------------
+enum class JournalState { Pending, Running, Done, Failed, Cancelled };
+
+// One planned provisioning step: "locale" and "timezone" carry their target,
+// "install" the apps it installs
+struct JournalStep {
+    std::string kind;
+    std::string target;
+    std::vector<InstallItem> items;
+    JournalState state;
+};
+
+// A single apt-get run of an install
+struct InstallStep {
+    std::string label;      // shown until apt reports progress
+    std::vector<std::string> argv;
+};
+
+// An install runs its steps one after another (index local repositories,
+// install from them, install from the mirrors); progress arrives on apt's
+// status fd
+struct InstallJob {
+    GPid pid;
+    guint serial;           // bumped per run so stale exits and reads are ignored
+    GIOChannel* status;     // apt's APT::Status-Fd stream
+    guint status_watch;
+    std::vector<std::string> packages;
+    std::vector<InstallStep> steps;
+    size_t step;            // the running step
+    bool preparing;         // local repositories are being indexed on a worker
+    int journal_step;       // this install's entry in the journal, or -1
+    InstallState state;
+    std::string phase;      // "download", "unpack" or "configure", for the timing report
+    gint64 phase_started;
+    gint64 step_started;
+    bool saw_download;      // download progress counts as the first half
+    double fraction;
+    std::string action;
+};
+
+// package -> installed version, read straight from dpkg's status file
+struct DpkgStatusIndex {
+    FileStamp stamp;
+    bool loaded;
+    std::unordered_map<std::string, std::string> installed;
+};
+
+// package -> candidate metadata from apt's downloaded Packages lists
+struct AptPackageInfo {
+    std::string version;
+    uint64_t installed_size_kb;
+    uint64_t size;
+};
+
+struct AptListsIndex {
+    std::vector<std::pair<std::string, FileStamp>> lists;   // what `packages` was built from
+    bool loaded;
+    bool building;
+    std::unordered_map<std::string, AptPackageInfo> packages;
+};
+
+// Background `apt-get --download-only` for apps the user is looking at, so an
+// install later only has to unpack and configure
+struct PrefetchJob {
+    GPid pid;
+    std::vector<std::string> wanted;            // every package picked so far, in order
+    std::unordered_set<std::string> known;      // same set, for lookups
+    size_t covered;                             // prefix of `wanted` already fetched or in flight
+    size_t in_flight;                           // prefix size the running job will cover
+    bool install_pending;                       // Install pressed while a download was running
+    std::vector<InstallItem> pending_items;
+    bool pending_repair;
+};
+
+// ---------------- Timing report ----------------
+// One timed operation; times are g_get_monotonic_time() microseconds
+struct TimingRecord {
+    std::string step;
+    std::string detail;
+    gint64 start;
+    gint64 end;
+    int exit_code;          // -1 when the step isn't a process
+    std::string status;     // "ok", "failed" or "cancelled"
+};
+
+// Appended to from worker threads too, hence the mutex
+struct TimingLog {
+    std::mutex mu;
+    gint64 origin;          // process start
+    std::vector<TimingRecord> records;
+    bool report_enabled;    // finish page reached: keep the report file current
+    bool write_scheduled;
+};
+
 // ---------------- AppWidgets (unified) ----------------
 struct AppWidgets {
     GtkWidget *window;
     GtkWidget *stack;
+    std::unordered_set<std::string> built_pages;
 
     // Network
     GtkWidget *iface_combo;
@@ -30,46 +460,356 @@ struct AppWidgets {
     std::string selected_wifi;
 
     // Locale
-    GtkWidget *locale_combo;
-    GtkWidget *tz_combo;
+    GtkWidget *locale_search;
+    GtkWidget *locale_view;
+    GtkTreeStore *locale_store;
+    GtkTreeModel *locale_filter;
+    GtkWidget *tz_search;
+    GtkWidget *tz_view;
+    GtkTreeStore *tz_store;
+    GtkTreeModel *tz_filter;
     std::string selected_lang;
     std::string selected_tz;
+    bool lang_chosen;       // picked (or resumed), not just preselected from the system
+    bool tz_chosen;
+    std::vector<LocaleEntry> locale_list;
+    std::vector<std::pair<std::string, int>> locale_index;  // sorted (token, entry) for prefix lookup
+    std::vector<int> locale_group_of;       // index into locale_groups
+    std::vector<std::string> locale_groups;
+    std::vector<char> locale_visible;
+    std::vector<char> locale_group_visible;
+    std::vector<std::string> tz_list;
+    std::vector<std::string> tz_folded;     // lowercase, '_' as space, for matching
+    std::vector<int> tz_region_of;          // index into tz_regions, -1 for top-level zones
+    std::vector<std::string> tz_regions;
+    std::vector<char> tz_visible;
+    std::vector<char> tz_region_visible;
+    bool locale_lists_ready;
+    LocaleGenJob localegen;
+    TimezoneJob tzjob;
 
     // Apps & summary
-    GtkWidget *apps_list_box;
+    GtkWidget *apps_view;
+    GtkListStore *apps_store;
+    GtkTreeModel *apps_filter;
+    GtkWidget *apps_search;
     GtkWidget *apps_scrolled;
     GtkWidget *summary_box;
     GtkWidget *summary_logo;
     GtkWidget *summary_name;
     GtkWidget *summary_desc;
+    GtkWidget *summary_install_btn;
+    GtkWidget *summary_edit_btn;
+    GtkWidget *install_progress;
+    GtkWidget *install_action;
+    GtkWidget *install_cancel_btn;
+    InstallJob install;
+    PrefetchJob prefetch;
+    std::vector<JournalStep> journal;
+    TimingLog timings;
+    bool journal_resuming;                                // replaying incomplete journal steps
+    DpkgStatusIndex dpkg_status;
+    AptListsIndex apt_lists;
+    GtkWidget *summary_pkg_info;
     std::string selected_package;
+    std::string selected_repo;
     fs::path selected_json_path;
+    guint catalog_generation;
+    Catalog catalog;
+    std::vector<GtkTreeIter> app_rows;                    // by catalog id; list store iters persist
+    GFileMonitor* apps_monitor;
+    LogoQueue logo_queue;
+    GdkPixbuf* default_logo;                              // shared placeholder for every row
+    bool default_logo_missing;                            // don't retry the disk for every row
+    guint logo_prioritize_idle;                           // coalesces scroll ticks to one pass per frame
+    std::unordered_set<std::string> catalog_dirty;        // paths waiting to be re-parsed
+    guint catalog_dirty_timer;
+    std::unordered_set<std::string> catalog_removed;      // deleted since the current load started
+    std::vector<char> catalog_seen;                       // by catalog id: delivered since the last full load began
+    std::unordered_set<std::string> apps_checked;         // JSON paths ticked for batch install
+    GtkWidget *apps_install_btn;
+    std::vector<std::string> apps_query;                  // lowercased search words
+    std::vector<char> apps_visible;                       // by catalog id, while a query is active
 };
 
 // ---------------- Utility helpers ----------------
-static std::vector<std::string> get_locales() {
-    std::vector<std::string> locales;
-    FILE* fp = popen("locale -a", "r");
-    if (!fp) return locales;
-    char line[512];
-    while (fgets(line, sizeof(line), fp)) {
-        line[strcspn(line, "\n")] = 0;
-        if (strlen(line) > 0) locales.push_back(line);
-    }
-    pclose(fp);
+// Locales are enumerated natively: generated ones come from the compiled
+// locale archive (plus per-locale directories), generatable ones from the
+// i18n SUPPORTED list. `locale -a` only knows about the former.
+static const char* LOCALE_ARCHIVE = "/usr/lib/locale/locale-archive";
+static const char* LOCALE_DIR = "/usr/lib/locale";
+static const char* SUPPORTED_LOCALES = "/usr/share/i18n/SUPPORTED";
+
+// Same folding glibc applies to codesets: "UTF-8" -> "utf8", "8859-1" -> "iso88591"
+static std::string normalize_locale_name(const std::string& name) {
+    size_t dot = name.find('.');
+    if (dot == std::string::npos) return name;
+    size_t at = name.find('@', dot);
+    std::string codeset = name.substr(dot + 1, at == std::string::npos ? std::string::npos : at - dot - 1);
+    std::string norm;
+    bool only_digits = true;
+    for (char c : codeset) {
+        if (isalpha((unsigned char)c)) {
+            norm += (char)tolower((unsigned char)c);
+            only_digits = false;
+        } else if (isdigit((unsigned char)c)) {
+            norm += c;
+        }
+    }
+    if (only_digits) norm = "iso" + norm;
+    return name.substr(0, dot + 1) + norm + (at == std::string::npos ? "" : name.substr(at));
+}
+
+// Spell the archive's "utf8" the way SUPPORTED and users do: en_GB.utf8 -> en_GB.UTF-8
+static std::string canonical_locale_name(const std::string& name) {
+    std::string norm = normalize_locale_name(name);
+    size_t dot = norm.find('.');
+    if (dot == std::string::npos || norm.compare(dot + 1, 4, "utf8") != 0) return name;
+    if (norm.size() > dot + 5 && norm[dot + 5] != '@') return name;
+    return norm.substr(0, dot + 1) + "UTF-8" + norm.substr(dot + 5);
+}
+
+// Layout of glibc's locarchive.h header and name hash entries
+struct LocArchiveHead {
+    uint32_t magic;
+    uint32_t serial;
+    uint32_t namehash_offset;
+    uint32_t namehash_used;
+    uint32_t namehash_size;
+    uint32_t string_offset;
+    uint32_t string_used;
+    uint32_t string_size;
+    uint32_t locrectab_offset;
+    uint32_t locrectab_used;
+    uint32_t locrectab_size;
+    uint32_t sumhash_offset;
+    uint32_t sumhash_used;
+    uint32_t sumhash_size;
+};
+
+struct LocArchiveNameHashEnt {
+    uint32_t hashval;
+    uint32_t name_offset;
+    uint32_t locrec_offset;
+};
+
+static const uint32_t LOCARCHIVE_MAGIC = 0xde020109;
+
+static void read_locale_archive(const char* path, std::vector<std::string>& names) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(LocArchiveHead)) {
+        close(fd);
+        return;
+    }
+    size_t size = st.st_size;
+    void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return;
+
+    // Only the header, name hash and the names themselves are touched
+    const char* base = (const char*)map;
+    const LocArchiveHead* head = (const LocArchiveHead*)base;
+    if (head->magic == LOCARCHIVE_MAGIC &&
+        head->namehash_offset + (uint64_t)head->namehash_size * sizeof(LocArchiveNameHashEnt) <= size) {
+        const LocArchiveNameHashEnt* ents = (const LocArchiveNameHashEnt*)(base + head->namehash_offset);
+        for (uint32_t i = 0; i < head->namehash_size; ++i) {
+            if (ents[i].locrec_offset == 0 || ents[i].name_offset >= size) continue;
+            const char* name = base + ents[i].name_offset;
+            size_t len = strnlen(name, size - ents[i].name_offset);
+            if (len > 0 && ents[i].name_offset + len < size) names.emplace_back(name, len);
+        }
+    }
+    munmap(map, size);
+}
+
+// Locales compiled outside the archive (e.g. Debian's C.utf8) live in their own directory
+static void read_locale_dirs(const char* path, std::vector<std::string>& names) {
+    std::error_code ec;
+    for (auto& entry : fs::directory_iterator(path, ec)) {
+        if (entry.is_directory(ec) && fs::exists(entry.path() / "LC_CTYPE", ec))
+            names.push_back(entry.path().filename().string());
+    }
+}
+
+static std::vector<LocaleEntry> get_locales() {
+    std::vector<std::string> generated = {"C", "POSIX"};
+    read_locale_archive(LOCALE_ARCHIVE, generated);
+    read_locale_dirs(LOCALE_DIR, generated);
+
+    std::unordered_set<std::string> generated_norm;
+    for (auto& name : generated) generated_norm.insert(normalize_locale_name(name));
+
+    std::vector<LocaleEntry> locales;
+    std::unordered_set<std::string> seen;
+
+    // SUPPORTED: "<name> <charmap>" per line
+    std::ifstream ifs(SUPPORTED_LOCALES);
+    std::string line;
+    while (std::getline(ifs, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        size_t sp = line.find(' ');
+        std::string name = line.substr(0, sp);
+        std::string charmap = sp == std::string::npos ? "" : line.substr(sp + 1);
+        charmap.erase(charmap.find_last_not_of(" \t\r") + 1);
+        std::string norm = normalize_locale_name(name);
+        if (name.empty() || !seen.insert(norm).second) continue;
+        locales.push_back({name, charmap, generated_norm.count(norm) == 0, "", ""});
+    }
+    // Generated locales that SUPPORTED doesn't list (custom builds, C/POSIX)
+    for (auto& name : generated) {
+        if (seen.insert(normalize_locale_name(name)).second)
+            locales.push_back({canonical_locale_name(name), "", false, "", ""});
+    }
+
+    std::sort(locales.begin(), locales.end(),
+              [](const LocaleEntry& a, const LocaleEntry& b) { return a.name < b.name; });
     return locales;
 }
 
+// Human-readable language and territory names come from the iso-codes
+// package when it is installed; otherwise the raw codes are shown.
+static const char* ISO_639_JSON = "/usr/share/iso-codes/json/iso_639-2.json";
+static const char* ISO_3166_JSON = "/usr/share/iso-codes/json/iso_3166-1.json";
+
+static std::unordered_map<std::string, std::string> load_iso_names(const char* path, const char* key) {
+    std::unordered_map<std::string, std::string> names;
+    std::ifstream ifs(path);
+    if (!ifs.is_open()) return names;
+    try {
+        json j;
+        ifs >> j;
+        for (auto& e : j.at(key)) {
+            // "Spanish; Castilian" -> "Spanish"
+            std::string name = e.value("common_name", e.value("name", ""));
+            name = name.substr(0, name.find(';'));
+            if (e.contains("alpha_2")) names[e["alpha_2"].get<std::string>()] = name;
+            if (e.contains("alpha_3")) names[e["alpha_3"].get<std::string>()] = name;
+        }
+    } catch (...) {
+        g_print("Failed to parse JSON: %s\n", path);
+    }
+    return names;
+}
+
+// Fill in language/territory and order the list by them so groups are contiguous
+static void describe_locales(std::vector<LocaleEntry>& locales) {
+    auto languages = load_iso_names(ISO_639_JSON, "639-2");
+    auto territories = load_iso_names(ISO_3166_JSON, "3166-1");
+    for (auto& loc : locales) {
+        size_t lang_end = loc.name.find_first_of("_.@");
+        std::string lang = loc.name.substr(0, lang_end);
+        std::string terr;
+        if (lang_end != std::string::npos && loc.name[lang_end] == '_') {
+            size_t terr_end = loc.name.find_first_of(".@", lang_end + 1);
+            terr = loc.name.substr(lang_end + 1, terr_end == std::string::npos ? std::string::npos : terr_end - lang_end - 1);
+        }
+        auto l = languages.find(lang);
+        loc.language = l != languages.end() ? l->second : lang;
+        auto t = territories.find(terr);
+        loc.territory = t != territories.end() ? t->second : terr;
+    }
+    std::sort(locales.begin(), locales.end(), [](const LocaleEntry& a, const LocaleEntry& b) {
+        if (a.language != b.language) return a.language < b.language;
+        if (a.territory != b.territory) return a.territory < b.territory;
+        return a.name < b.name;
+    });
+}
+
+// Every word of the code, language and territory, lowercased, for prefix lookup
+static std::vector<std::pair<std::string, int>> build_locale_index(const std::vector<LocaleEntry>& locales) {
+    std::vector<std::pair<std::string, int>> index;
+    for (size_t i = 0; i < locales.size(); ++i) {
+        const LocaleEntry& loc = locales[i];
+        std::string text = loc.name + " " + loc.language + " " + loc.territory;
+        for (auto& c : text) c = (char)tolower((unsigned char)c);
+        index.emplace_back(text.substr(0, loc.name.size()), (int)i);
+        size_t pos = 0;
+        while ((pos = text.find_first_not_of(" _.@,()", pos)) != std::string::npos) {
+            size_t end = text.find_first_of(" _.@,()", pos);
+            index.emplace_back(text.substr(pos, end == std::string::npos ? std::string::npos : end - pos), (int)i);
+            pos = end;
+        }
+    }
+    std::sort(index.begin(), index.end());
+    index.erase(std::unique(index.begin(), index.end()), index.end());
+    return index;
+}
+
+// Timezones are read straight from the tz database instead of going through
+// `timedatectl`, which needs systemd-timedated (and D-Bus) to be up.
+static const char* ZONEINFO_DIR = "/usr/share/zoneinfo";
+
+// tzdata.zi is zic's compact input: "Z <name> ..." for zones, "L <target> <name>" for links
+static bool read_tzdata_zi(const fs::path& file, std::vector<std::string>& zones) {
+    std::ifstream ifs(file);
+    if (!ifs.is_open()) return false;
+    std::string line;
+    while (std::getline(ifs, line)) {
+        if (line.size() < 3 || line[1] != ' ') continue;
+        if (line[0] == 'Z') {
+            size_t end = line.find(' ', 2);
+            zones.push_back(line.substr(2, end == std::string::npos ? std::string::npos : end - 2));
+        } else if (line[0] == 'L') {
+            size_t sep = line.find(' ', 2);
+            if (sep == std::string::npos) continue;
+            size_t end = line.find(' ', sep + 1);
+            zones.push_back(line.substr(sep + 1, end == std::string::npos ? std::string::npos : end - sep - 1));
+        }
+    }
+    return !zones.empty();
+}
+
+// zone1970.tab: "<codes>\t<coordinates>\t<TZ>[\t<comment>]"
+static bool read_zone_tab(const fs::path& file, std::vector<std::string>& zones) {
+    std::ifstream ifs(file);
+    if (!ifs.is_open()) return false;
+    std::string line;
+    while (std::getline(ifs, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        size_t t1 = line.find('\t');
+        size_t t2 = t1 == std::string::npos ? t1 : line.find('\t', t1 + 1);
+        if (t2 == std::string::npos) continue;
+        size_t t3 = line.find('\t', t2 + 1);
+        zones.push_back(line.substr(t2 + 1, t3 == std::string::npos ? std::string::npos : t3 - t2 - 1));
+    }
+    zones.push_back("UTC");
+    return zones.size() > 1;
+}
+
+// Last resort: every compiled zone file under the zoneinfo tree
+static void walk_zoneinfo(const fs::path& root, std::vector<std::string>& zones) {
+    std::error_code ec;
+    fs::recursive_directory_iterator it(root, ec), end;
+    for (; !ec && it != end; it.increment(ec)) {
+        const fs::path& p = it->path();
+        std::string name = p.filename().string();
+        // Skip posix/ and right/ duplicates and lowercase metadata (zone.tab, leapseconds, ...)
+        if (name.empty() || !isupper((unsigned char)name[0])) {
+            if (it->is_directory(ec)) it.disable_recursion_pending();
+            continue;
+        }
+        if (!it->is_regular_file(ec)) continue;
+        char magic[4] = {};
+        std::ifstream ifs(p, std::ios::binary);
+        if (!ifs.read(magic, sizeof(magic)) || memcmp(magic, "TZif", 4) != 0) continue;
+        zones.push_back(fs::relative(p, root, ec).string());
+    }
+}
+
 static std::vector<std::string> get_timezones() {
     std::vector<std::string> zones;
-    FILE* fp = popen("timedatectl list-timezones", "r");
-    if (!fp) return zones;
-    char line[512];
-    while (fgets(line, sizeof(line), fp)) {
-        line[strcspn(line, "\n")] = 0;
-        if (strlen(line) > 0) zones.push_back(line);
-    }
-    pclose(fp);
+    fs::path root = ZONEINFO_DIR;
+    if (!read_tzdata_zi(root / "tzdata.zi", zones)) {
+        zones.clear();
+        if (!read_zone_tab(root / "zone1970.tab", zones)) {
+            zones.clear();
+            walk_zoneinfo(root, zones);
+        }
+    }
+    std::sort(zones.begin(), zones.end());
+    zones.erase(std::unique(zones.begin(), zones.end()), zones.end());
     return zones;
 }
 
@@ -83,24 +823,97 @@ void setup_finish_screen(AppWidgets* aw);
 
 void load_prescribed_apps(AppWidgets* aw);
 void reload_prescribed_apps(AppWidgets* aw);
+static void remove_app_row(AppWidgets* aw, const std::string& path);
 static void edit_json_btn_clicked(GtkButton* button, gpointer data);
 void show_summary(AppWidgets* aw, const std::string& name, const std::string& description,
                   const std::string& logo, const std::string& package, const fs::path& json_path);
+static void localegen_start(AppWidgets* aw, const std::string& name);
+static void locale_apply(AppWidgets* aw);
+static int journal_begin(AppWidgets* aw, const std::string& kind, const std::string& target,
+                         const std::vector<InstallItem>& items);
+static void journal_plan(AppWidgets* aw, const std::string& kind, const std::string& target);
+static void journal_end(AppWidgets* aw, int index, JournalState state);
+static void journal_resume_next(AppWidgets* aw);
+static void prefetch_start(AppWidgets* aw);
+static void prefetch_request(AppWidgets* aw, const std::string& package_field);
+static void prefetch_forget(AppWidgets* aw, const std::string& package_field);
+
+// ---------------- Lazy page registry ----------------
+// Pages are only built the first time the stack is asked to show them, so
+// startup pays for the welcome page alone.
+struct PageFactory {
+    const char* name;
+    void (*build)(AppWidgets* aw);
+};
+
+static const PageFactory page_factories[] = {
+    {"welcome", setup_welcome_screen},
+    {"network", setup_network_screen},
+    {"locale",  setup_locale_screen},
+    {"apps",    [](AppWidgets* aw) { setup_apps_screen(aw); load_prescribed_apps(aw); }},
+    {"summary", setup_summary_screen},
+    {"finish",  setup_finish_screen},
+};
+
+static void ensure_page(AppWidgets* aw, const char* name) {
+    if (aw->built_pages.count(name)) return;
+    for (auto& f : page_factories) {
+        if (strcmp(f.name, name) != 0) continue;
+        aw->built_pages.insert(name);
+        f.build(aw);
+        // The window was already shown, so newly added pages need showing too
+        GtkWidget* page = gtk_stack_get_child_by_name(GTK_STACK(aw->stack), name);
+        if (page) gtk_widget_show_all(page);
+        return;
+    }
+}
+
+static void show_page(AppWidgets* aw, const char* name) {
+    ensure_page(aw, name);
+    gtk_stack_set_visible_child_name(GTK_STACK(aw->stack), name);
+}
 
 // ---------------- Navigation callbacks ----------------
 static void welcome_continue_cb(GtkButton* button, gpointer data) {
     AppWidgets* aw = (AppWidgets*)data;
-    gtk_stack_set_visible_child_name(GTK_STACK(aw->stack), "network");
+    show_page(aw, "network");
 }
 
 static void skip_to_locale_cb(GtkButton* button, gpointer data) {
     AppWidgets* aw = (AppWidgets*)data;
-    gtk_stack_set_visible_child_name(GTK_STACK(aw->stack), "locale");
+    show_page(aw, "locale");
 }
 
 static void back_to_network_cb(GtkButton* button, gpointer data) {
     AppWidgets* aw = (AppWidgets*)data;
-    gtk_stack_set_visible_child_name(GTK_STACK(aw->stack), "network");
+    show_page(aw, "network");
+}
+
+// ---------------- Timing report ----------------
+// Every long operation is timed against the monotonic clock. Once the finish
+// page is reached the records are written to ~/sm_conf/timings.json, and the
+// file is refreshed whenever a step still running then completes.
+static void timing_write_report(AppWidgets* aw);
+
+static void timing_record(AppWidgets* aw, const std::string& step, const std::string& detail,
+                          gint64 start, gint64 end, const std::string& status, int exit_code = -1) {
+    TimingLog& log = aw->timings;
+    std::lock_guard<std::mutex> lock(log.mu);
+    log.records.push_back({step, detail, start, end, exit_code, status});
+    if (log.report_enabled && !log.write_scheduled) {
+        log.write_scheduled = true;
+        g_idle_add([](gpointer data) -> gboolean {
+            timing_write_report((AppWidgets*)data);
+            return G_SOURCE_REMOVE;
+        }, aw);
+    }
+}
+
+// Exit code and status of a child from its wait status
+static void timing_record_child(AppWidgets* aw, const std::string& step, const std::string& detail,
+                                gint64 start, gint status) {
+    int code = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    timing_record(aw, step, detail, start, g_get_monotonic_time(), code == 0 ? "ok" : "failed", code);
 }
 
 // ---------------- Wi-Fi scanning (async) ----------------
@@ -126,15 +939,18 @@ static void wifi_scan_finish(gpointer arg) {
 
 static void wifi_scan_thread(WiFiThreadData* data) {
     std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    gint64 start = g_get_monotonic_time();
     FILE* fp = popen("sudo nmcli -t -f SSID dev wifi list", "r");
+    int status = -1;
     if (fp) {
         char line[512];
         while (fgets(line, sizeof(line), fp)) {
             line[strcspn(line, "\n")] = 0;
             if (strlen(line) > 0) data->networks.push_back(line);
         }
-        pclose(fp);
+        status = pclose(fp);
     }
+    timing_record_child(data->aw, "wifi_scan", std::to_string(data->networks.size()) + " networks", start, status);
     // Push back to main thread for GTK updates
     g_idle_add((GSourceFunc)[](gpointer arg)->gboolean {
         wifi_scan_finish(arg);
@@ -181,24 +997,875 @@ static void wifi_changed_cb(GtkComboBox* combo, gpointer user_data) {
     }
 }
 
-static void locale_changed_cb(GtkComboBox* combo, gpointer user_data) {
+// Rows carry an index into aw->locale_list; language rows use -1 - group index
+enum { LOC_COL_LABEL, LOC_COL_NOTE, LOC_COL_INDEX, LOC_N_COLS };
+
+static void locale_selection_changed_cb(GtkTreeSelection* selection, gpointer user_data) {
     AppWidgets* aw = (AppWidgets*)user_data;
-    gchar* text = gtk_combo_box_text_get_active_text(GTK_COMBO_BOX_TEXT(combo));
-    if (text) {
-        aw->selected_lang = text;
-        g_free(text);
+    GtkTreeModel* model;
+    GtkTreeIter iter;
+    if (!gtk_tree_selection_get_selected(selection, &model, &iter)) return;
+    gint index = -1;
+    gtk_tree_model_get(model, &iter, LOC_COL_INDEX, &index, -1);
+    if (index < 0 || index >= (gint)aw->locale_list.size()) return;
+    aw->selected_lang = aw->locale_list[index].name;
+    aw->lang_chosen = true;
+    journal_plan(aw, "locale", aw->selected_lang);
+    // Compile it now so it is ready by the time the wizard finishes
+    localegen_start(aw, aw->selected_lang);
+}
+
+// Rows carry an index into aw->tz_list; region rows use -1 - region index
+enum { TZ_COL_LABEL, TZ_COL_INDEX, TZ_N_COLS };
+
+static void tz_selection_changed_cb(GtkTreeSelection* selection, gpointer user_data) {
+    AppWidgets* aw = (AppWidgets*)user_data;
+    GtkTreeModel* model;
+    GtkTreeIter iter;
+    if (!gtk_tree_selection_get_selected(selection, &model, &iter)) return;
+    gint index = -1;
+    gtk_tree_model_get(model, &iter, TZ_COL_INDEX, &index, -1);
+    if (index < 0 || index >= (gint)aw->tz_list.size()) return;
+    aw->selected_tz = aw->tz_list[index];
+    aw->tz_chosen = true;
+    journal_plan(aw, "timezone", aw->selected_tz);
+}
+
+// Show the row for the current choice without re-running the changed
+// handler: the choice is already recorded and needs no new work
+static void picker_select_row(GtkWidget* view, GtkTreeModel* filter, GtkTreeIter* child_iter,
+                              GCallback changed_cb, AppWidgets* aw) {
+    GtkTreeIter iter;
+    if (!gtk_tree_model_filter_convert_child_iter_to_filter_iter(GTK_TREE_MODEL_FILTER(filter), &iter, child_iter)) return;
+    GtkTreeSelection* selection = gtk_tree_view_get_selection(GTK_TREE_VIEW(view));
+    GtkTreePath* path = gtk_tree_model_get_path(filter, &iter);
+    g_signal_handlers_block_by_func(selection, (gpointer)changed_cb, aw);
+    gtk_tree_view_expand_to_path(GTK_TREE_VIEW(view), path);
+    gtk_tree_selection_select_iter(selection, &iter);
+    g_signal_handlers_unblock_by_func(selection, (gpointer)changed_cb, aw);
+    gtk_tree_view_scroll_to_cell(GTK_TREE_VIEW(view), path, NULL, TRUE, 0.5, 0);
+    gtk_tree_path_free(path);
+}
+
+// ---------------- Locale picker ----------------
+// Language -> territory tree behind a filter model, searched through the
+// prefix index built on the enumeration worker.
+static gboolean locale_row_visible(GtkTreeModel* model, GtkTreeIter* iter, gpointer user_data) {
+    AppWidgets* aw = (AppWidgets*)user_data;
+    if (!aw->locale_lists_ready) return TRUE;
+    gint index = 0;
+    gtk_tree_model_get(model, iter, LOC_COL_INDEX, &index, -1);
+    if (index >= 0) return index < (gint)aw->locale_visible.size() && aw->locale_visible[index];
+    size_t group = (size_t)(-1 - index);
+    return group < aw->locale_group_visible.size() && aw->locale_group_visible[group];
+}
+
+// Every query word must prefix-match some word of the entry
+static void locale_apply_filter(AppWidgets* aw, const char* query) {
+    std::string q = query ? query : "";
+    for (auto& c : q) c = (char)tolower((unsigned char)c);
+
+    size_t n = aw->locale_list.size();
+    aw->locale_visible.assign(n, 1);
+    std::vector<char> hit(n);
+    size_t pos = 0;
+    while ((pos = q.find_first_not_of(' ', pos)) != std::string::npos) {
+        size_t end = q.find(' ', pos);
+        std::string word = q.substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+        pos = end;
+
+        std::fill(hit.begin(), hit.end(), 0);
+        auto it = std::lower_bound(aw->locale_index.begin(), aw->locale_index.end(),
+                                   std::make_pair(word, -1));
+        for (; it != aw->locale_index.end() && it->first.compare(0, word.size(), word) == 0; ++it)
+            hit[it->second] = 1;
+        for (size_t i = 0; i < n; ++i) aw->locale_visible[i] &= hit[i];
+    }
+
+    aw->locale_group_visible.assign(aw->locale_groups.size(), 0);
+    for (size_t i = 0; i < n && i < aw->locale_group_of.size(); ++i) {
+        if (aw->locale_visible[i]) aw->locale_group_visible[aw->locale_group_of[i]] = 1;
+    }
+    if (!aw->locale_filter) return;
+    gtk_tree_model_filter_refilter(GTK_TREE_MODEL_FILTER(aw->locale_filter));
+    if (q.find_first_not_of(' ') == std::string::npos) gtk_tree_view_collapse_all(GTK_TREE_VIEW(aw->locale_view));
+    else gtk_tree_view_expand_all(GTK_TREE_VIEW(aw->locale_view));
+}
+
+static void locale_search_changed_cb(GtkSearchEntry* entry, gpointer user_data) {
+    locale_apply_filter((AppWidgets*)user_data, gtk_entry_get_text(GTK_ENTRY(entry)));
+}
+
+static void fill_locale_picker(AppWidgets* aw) {
+    if (!aw->locale_store) return;
+
+    // Detach while bulk-inserting so the view doesn't track every row
+    gtk_tree_view_set_model(GTK_TREE_VIEW(aw->locale_view), NULL);
+    gtk_tree_store_clear(aw->locale_store);
+    aw->locale_groups.clear();
+    aw->locale_group_of.clear();
+
+    GtkTreeIter selected_iter;
+    bool have_selected = false;
+    if (aw->locale_lists_ready) {
+        // locale_list is ordered by language, so each group is contiguous
+        GtkTreeIter group_iter;
+        for (size_t i = 0; i < aw->locale_list.size(); ++i) {
+            const LocaleEntry& loc = aw->locale_list[i];
+            if (aw->locale_groups.empty() || aw->locale_groups.back() != loc.language) {
+                aw->locale_groups.push_back(loc.language);
+                gtk_tree_store_insert_with_values(aw->locale_store, &group_iter, NULL, -1,
+                                                  LOC_COL_LABEL, loc.language.c_str(), LOC_COL_NOTE, "",
+                                                  LOC_COL_INDEX, -(gint)aw->locale_groups.size(), -1);
+            }
+            aw->locale_group_of.push_back((int)aw->locale_groups.size() - 1);
+            std::string label = loc.territory.empty() ? loc.name : loc.territory + " (" + loc.name + ")";
+            GtkTreeIter iter;
+            gtk_tree_store_insert_with_values(aw->locale_store, &iter, &group_iter, -1,
+                                              LOC_COL_LABEL, label.c_str(),
+                                              LOC_COL_NOTE, loc.needs_generation ? "not generated" : "",
+                                              LOC_COL_INDEX, (gint)i, -1);
+            if (loc.name == aw->selected_lang) {
+                selected_iter = iter;
+                have_selected = true;
+            }
+        }
+    } else {
+        GtkTreeIter iter;
+        gtk_tree_store_insert_with_values(aw->locale_store, &iter, NULL, -1,
+                                          LOC_COL_LABEL, "Loading\u2026", LOC_COL_NOTE, "",
+                                          LOC_COL_INDEX, -1, -1);
+    }
+
+    locale_apply_filter(aw, gtk_entry_get_text(GTK_ENTRY(aw->locale_search)));
+    gtk_tree_view_set_model(GTK_TREE_VIEW(aw->locale_view), aw->locale_filter);
+    if (have_selected) {
+        picker_select_row(aw->locale_view, aw->locale_filter, &selected_iter,
+                          G_CALLBACK(locale_selection_changed_cb), aw);
     }
+    gtk_widget_set_sensitive(aw->locale_view, aw->locale_lists_ready);
+    gtk_widget_set_sensitive(aw->locale_search, aw->locale_lists_ready);
 }
 
-static void tz_changed_cb(GtkComboBox* combo, gpointer user_data) {
+// ---------------- Timezone picker ----------------
+// Region -> city tree behind a filter model. The view runs in fixed-height
+// mode so only the rows on screen are measured and rendered.
+static gboolean tz_row_visible(GtkTreeModel* model, GtkTreeIter* iter, gpointer user_data) {
     AppWidgets* aw = (AppWidgets*)user_data;
-    gchar* text = gtk_combo_box_text_get_active_text(GTK_COMBO_BOX_TEXT(combo));
-    if (text) {
-        aw->selected_tz = text;
-        g_free(text);
+    if (!aw->locale_lists_ready) return TRUE;
+    gint index = 0;
+    gtk_tree_model_get(model, iter, TZ_COL_INDEX, &index, -1);
+    if (index >= 0) return index < (gint)aw->tz_visible.size() && aw->tz_visible[index];
+    size_t region = (size_t)(-1 - index);
+    return region < aw->tz_region_visible.size() && aw->tz_region_visible[region];
+}
+
+static void tz_apply_filter(AppWidgets* aw, const char* query) {
+    std::string q = query ? query : "";
+    for (auto& c : q) c = c == '_' ? ' ' : (char)tolower((unsigned char)c);
+
+    aw->tz_visible.assign(aw->tz_list.size(), 0);
+    aw->tz_region_visible.assign(aw->tz_regions.size(), 0);
+    for (size_t i = 0; i < aw->tz_list.size(); ++i) {
+        if (!q.empty() && aw->tz_folded[i].find(q) == std::string::npos) continue;
+        aw->tz_visible[i] = 1;
+        if (aw->tz_region_of[i] >= 0) aw->tz_region_visible[aw->tz_region_of[i]] = 1;
+    }
+    if (!aw->tz_filter) return;
+    gtk_tree_model_filter_refilter(GTK_TREE_MODEL_FILTER(aw->tz_filter));
+    if (q.empty()) gtk_tree_view_collapse_all(GTK_TREE_VIEW(aw->tz_view));
+    else gtk_tree_view_expand_all(GTK_TREE_VIEW(aw->tz_view));
+}
+
+static void tz_search_changed_cb(GtkSearchEntry* entry, gpointer user_data) {
+    tz_apply_filter((AppWidgets*)user_data, gtk_entry_get_text(GTK_ENTRY(entry)));
+}
+
+static void fill_tz_picker(AppWidgets* aw) {
+    if (!aw->tz_store) return;
+
+    // Detach while bulk-inserting so the view doesn't track every row
+    gtk_tree_view_set_model(GTK_TREE_VIEW(aw->tz_view), NULL);
+    gtk_tree_store_clear(aw->tz_store);
+    aw->tz_regions.clear();
+    aw->tz_folded.clear();
+    aw->tz_region_of.clear();
+
+    GtkTreeIter selected_iter;
+    bool have_selected = false;
+    if (aw->locale_lists_ready) {
+        // tz_list is sorted, so each region's zones are contiguous
+        GtkTreeIter region_iter;
+        for (size_t i = 0; i < aw->tz_list.size(); ++i) {
+            const std::string& zone = aw->tz_list[i];
+            std::string folded = zone;
+            for (auto& c : folded) c = c == '_' ? ' ' : (char)tolower((unsigned char)c);
+            aw->tz_folded.push_back(folded);
+
+            size_t slash = zone.find('/');
+            GtkTreeIter iter;
+            bool selected = zone == aw->selected_tz;
+            if (slash == std::string::npos) {
+                aw->tz_region_of.push_back(-1);
+                gtk_tree_store_insert_with_values(aw->tz_store, &iter, NULL, -1,
+                                                  TZ_COL_LABEL, zone.c_str(), TZ_COL_INDEX, (gint)i, -1);
+                if (selected) {
+                    selected_iter = iter;
+                    have_selected = true;
+                }
+                continue;
+            }
+            std::string region = zone.substr(0, slash);
+            if (aw->tz_regions.empty() || aw->tz_regions.back() != region) {
+                aw->tz_regions.push_back(region);
+                gtk_tree_store_insert_with_values(aw->tz_store, &region_iter, NULL, -1,
+                                                  TZ_COL_LABEL, region.c_str(),
+                                                  TZ_COL_INDEX, -(gint)aw->tz_regions.size(), -1);
+            }
+            aw->tz_region_of.push_back((int)aw->tz_regions.size() - 1);
+            std::string city = zone.substr(slash + 1);
+            for (auto& c : city) if (c == '_') c = ' ';
+            gtk_tree_store_insert_with_values(aw->tz_store, &iter, &region_iter, -1,
+                                              TZ_COL_LABEL, city.c_str(), TZ_COL_INDEX, (gint)i, -1);
+            if (selected) {
+                selected_iter = iter;
+                have_selected = true;
+            }
+        }
+    } else {
+        GtkTreeIter iter;
+        gtk_tree_store_insert_with_values(aw->tz_store, &iter, NULL, -1,
+                                          TZ_COL_LABEL, "Loading\u2026", TZ_COL_INDEX, -1, -1);
+    }
+
+    tz_apply_filter(aw, gtk_entry_get_text(GTK_ENTRY(aw->tz_search)));
+    gtk_tree_view_set_model(GTK_TREE_VIEW(aw->tz_view), aw->tz_filter);
+    if (have_selected) {
+        picker_select_row(aw->tz_view, aw->tz_filter, &selected_iter, G_CALLBACK(tz_selection_changed_cb), aw);
+    }
+    gtk_widget_set_sensitive(aw->tz_view, aw->locale_lists_ready);
+    gtk_widget_set_sensitive(aw->tz_search, aw->locale_lists_ready);
+}
+
+// ---------------- Locale / timezone enumeration (async) ----------------
+// Both lists touch the disk (the locale archive can be large), so they are
+// gathered on a worker started at launch.
+struct LocaleListData {
+    AppWidgets* aw;
+    std::vector<LocaleEntry> locales;
+    std::vector<std::pair<std::string, int>> locale_index;
+    std::vector<std::string> timezones;
+};
+
+// The system's current LANG, from /etc/default/locale or the environment
+static std::string system_locale() {
+    std::ifstream ifs("/etc/default/locale");
+    std::string line;
+    while (std::getline(ifs, line)) {
+        if (line.rfind("LANG=", 0) != 0) continue;
+        std::string value = line.substr(5);
+        if (value.size() >= 2 && (value[0] == '"' || value[0] == '\'')) value = value.substr(1, value.size() - 2);
+        return value;
+    }
+    const char* env = getenv("LANG");
+    return env ? env : "";
+}
+
+// The system's current zone, from /etc/timezone or the /etc/localtime link
+static std::string system_timezone() {
+    std::ifstream ifs("/etc/timezone");
+    std::string zone;
+    if (std::getline(ifs, zone) && !zone.empty()) return zone;
+    std::error_code ec;
+    std::string target = fs::read_symlink("/etc/localtime", ec).string();
+    size_t pos = target.find("zoneinfo/");
+    return pos == std::string::npos ? "" : target.substr(pos + 9);
+}
+
+// Preselect the current system setting unless a choice was made or resumed
+// already. Nothing is preselected when it isn't in the lists, and a
+// preselection is only shown, never applied.
+static void default_locale_choices(AppWidgets* aw) {
+    if (aw->selected_lang.empty()) {
+        std::string current = normalize_locale_name(system_locale());
+        for (const auto& loc : aw->locale_list) {
+            if (normalize_locale_name(loc.name) == current) {
+                aw->selected_lang = loc.name;
+                break;
+            }
+        }
+    }
+    if (aw->selected_tz.empty()) {
+        std::string current = system_timezone();
+        if (std::binary_search(aw->tz_list.begin(), aw->tz_list.end(), current)) aw->selected_tz = current;
+    }
+}
+
+static void locale_lists_finish(gpointer arg) {
+    LocaleListData* data = (LocaleListData*)arg;
+    data->aw->locale_list = std::move(data->locales);
+    data->aw->locale_index = std::move(data->locale_index);
+    data->aw->tz_list = std::move(data->timezones);
+    data->aw->locale_lists_ready = true;
+    default_locale_choices(data->aw);
+    // The locale page may not be built yet; it picks the lists up when it is
+    fill_locale_picker(data->aw);
+    fill_tz_picker(data->aw);
+    // The finish page (or a resumed journal) asked for the locale already
+    if (data->aw->localegen.apply_pending && data->aw->localegen.state != LocaleGenState::Running) {
+        data->aw->localegen.apply_pending = false;
+        locale_apply(data->aw);
+    }
+    delete data;
+}
+
+static void locale_lists_thread(LocaleListData* data) {
+    gint64 start = g_get_monotonic_time();
+    data->locales = get_locales();
+    describe_locales(data->locales);
+    data->locale_index = build_locale_index(data->locales);
+    gint64 mid = g_get_monotonic_time();
+    timing_record(data->aw, "locale_enumeration", std::to_string(data->locales.size()) + " locales", start, mid, "ok");
+    data->timezones = get_timezones();
+    timing_record(data->aw, "timezone_enumeration", std::to_string(data->timezones.size()) + " zones",
+                  mid, g_get_monotonic_time(), "ok");
+    // Push back to main thread for GTK updates
+    g_idle_add((GSourceFunc)[](gpointer arg)->gboolean {
+        locale_lists_finish(arg);
+        return G_SOURCE_REMOVE;
+    }, data);
+}
+
+static void start_locale_enumeration(AppWidgets* aw) {
+    LocaleListData* td = new LocaleListData{aw, {}, {}, {}};
+    std::thread(locale_lists_thread, td).detach();
+}
+
+// ---------------- Locale generation ----------------
+// Only the selected locale is compiled, with a single `localedef` instead of
+// a full `locale-gen`. The job starts as soon as a language is picked and is
+// restarted whenever the choice changes. A superseded localedef is never
+// killed (it may be halfway through rewriting the locale archive); its result
+// is ignored and the next one starts once it has exited.
+struct LocaleGenExit {
+    AppWidgets* aw;
+    guint serial;
+    std::string locale;
+    gint64 started;
+};
+
+static LocaleEntry* find_locale(AppWidgets* aw, const std::string& name) {
+    for (auto& loc : aw->locale_list) {
+        if (loc.name == name) return &loc;
+    }
+    return nullptr;
+}
+
+static void localegen_cancel(AppWidgets* aw) {
+    LocaleGenJob& job = aw->localegen;
+    job.serial++;
+    if (job.pid > 0) job.draining = job.pid;
+    job.pid = 0;
+    job.spawn_waiting = false;
+    job.apply_pending = false;
+    job.state = LocaleGenState::Idle;
+}
+
+static void localegen_spawn(AppWidgets* aw);
+
+static void localegen_exited(GPid pid, gint status, gpointer user_data) {
+    LocaleGenExit* ex = (LocaleGenExit*)user_data;
+    AppWidgets* aw = ex->aw;
+    LocaleGenJob& job = aw->localegen;
+    bool stale = ex->serial != job.serial;
+    g_spawn_close_pid(pid);
+    if (stale) {
+        int code = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+        timing_record(aw, "locale_generation", ex->locale, ex->started, g_get_monotonic_time(), "cancelled", code);
+        delete ex;
+        if (pid == job.draining) job.draining = 0;
+        if (!job.draining && job.spawn_waiting) {
+            job.spawn_waiting = false;
+            localegen_spawn(aw);
+        }
+        return;
+    }
+    delete ex;
+
+    job.pid = 0;
+    timing_record_child(aw, "locale_generation", job.locale, job.started, status);
+    if (g_spawn_check_exit_status(status, NULL)) {
+        job.state = LocaleGenState::Done;
+        if (LocaleEntry* loc = find_locale(aw, job.locale)) loc->needs_generation = false;
+    } else {
+        job.state = LocaleGenState::Failed;
+        g_print("Locale generation failed: %s\n", job.locale.c_str());
+    }
+    if (job.apply_pending) {
+        job.apply_pending = false;
+        locale_apply(aw);
+    }
+}
+
+// localedef, then the matching "<name> <charmap>" line in /etc/locale.gen is
+// uncommented (or appended) so the next locale-gen, e.g. from a libc
+// upgrade, keeps the locale. The file is replaced through a temp file.
+static const char* LOCALEGEN_SCRIPT =
+    "set -e\n"
+    "localedef -i \"$1\" -f \"$2\" \"$3\"\n"
+    "[ -f /etc/locale.gen ] || exit 0\n"
+    "awk -v name=\"$3\" -v charmap=\"$2\" '\n"
+    "  { line = $0; sub(/^#[ \\t]*/, \"\", line); n = split(line, f, /[ \\t]+/) }\n"
+    "  !done && n == 2 && f[1] == name && f[2] == charmap { print name \" \" charmap; done = 1; next }\n"
+    "  { print }\n"
+    "  END { if (!done) print name \" \" charmap }' /etc/locale.gen > /etc/.locale.gen.sm-tmp\n"
+    "chmod 0644 /etc/.locale.gen.sm-tmp\n"
+    "sync /etc/.locale.gen.sm-tmp\n"
+    "mv -f /etc/.locale.gen.sm-tmp /etc/locale.gen\n";
+
+// Run localedef for job.locale; the state is already Running
+static void localegen_spawn(AppWidgets* aw) {
+    LocaleGenJob& job = aw->localegen;
+    const std::string& name = job.locale;
+    LocaleEntry* loc = find_locale(aw, name);
+
+    // localedef wants the source name without the codeset: en_US.UTF-8 -> en_US
+    std::string input = name;
+    size_t dot = input.find('.');
+    if (dot != std::string::npos) {
+        size_t at = input.find('@', dot);
+        input.erase(dot, at == std::string::npos ? std::string::npos : at - dot);
+    }
+
+    gchar* argv[] = {
+        (gchar*)"sudo", (gchar*)"sh", (gchar*)"-c", (gchar*)LOCALEGEN_SCRIPT, (gchar*)"sh",
+        (gchar*)input.c_str(), (gchar*)loc->charmap.c_str(), (gchar*)name.c_str(), NULL
+    };
+    GError* err = NULL;
+    GPid pid = 0;
+    if (!g_spawn_async(NULL, argv, NULL,
+                       (GSpawnFlags)(G_SPAWN_SEARCH_PATH | G_SPAWN_DO_NOT_REAP_CHILD),
+                       NULL, NULL, &pid, &err)) {
+        g_print("Failed to start localedef: %s\n", err->message);
+        g_error_free(err);
+        gint64 now = g_get_monotonic_time();
+        timing_record(aw, "locale_generation", name, now, now, "failed");
+        job.state = LocaleGenState::Failed;
+        if (job.apply_pending) {
+            job.apply_pending = false;
+            locale_apply(aw);
+        }
+        return;
+    }
+    job.pid = pid;
+    job.started = g_get_monotonic_time();
+    g_child_watch_add(pid, localegen_exited, new LocaleGenExit{aw, job.serial, name, job.started});
+}
+
+static void localegen_start(AppWidgets* aw, const std::string& name) {
+    LocaleGenJob& job = aw->localegen;
+    if (job.locale == name && job.state != LocaleGenState::Idle && job.state != LocaleGenState::Failed) return;
+    localegen_cancel(aw);
+    job.locale = name;
+
+    LocaleEntry* loc = find_locale(aw, name);
+    if (!loc || !loc->needs_generation || loc->charmap.empty()) {
+        job.state = LocaleGenState::Done;
+        return;
+    }
+    job.state = LocaleGenState::Running;
+    // Wait for a superseded run to leave the archive alone
+    if (job.draining) job.spawn_waiting = true;
+    else localegen_spawn(aw);
+}
+
+// Make the selected locale the system default, once it has been compiled.
+// Runs update-locale at most once per choice, however often the finish page
+// is shown.
+static void locale_apply(AppWidgets* aw) {
+    // A preselected system locale is already in effect
+    if (aw->selected_lang.empty() || !aw->lang_chosen) return;
+    LocaleGenJob& job = aw->localegen;
+    if (job.applying) {
+        // Re-run once the current update-locale exits if the choice changed
+        if (job.applying_lang != aw->selected_lang) job.apply_pending = true;
+        return;
+    }
+    if (job.applied == aw->selected_lang) return;
+    int step = journal_begin(aw, "locale", aw->selected_lang, {});
+    // Which locales need compiling is only known once enumeration finished
+    if (!aw->locale_lists_ready) {
+        job.apply_pending = true;
+        return;
+    }
+    if (job.locale != aw->selected_lang || job.state == LocaleGenState::Idle) {
+        localegen_start(aw, aw->selected_lang);
+    }
+    if (job.state == LocaleGenState::Running) {
+        job.apply_pending = true;
+        return;
+    }
+    if (job.state == LocaleGenState::Failed) {
+        journal_end(aw, step, JournalState::Failed);
+        return;
+    }
+
+    std::string lang = "LANG=" + aw->selected_lang;
+    gchar* argv[] = { (gchar*)"sudo", (gchar*)"update-locale", (gchar*)lang.c_str(), NULL };
+    GError* err = NULL;
+    GPid pid = 0;
+    job.apply_started = g_get_monotonic_time();
+    if (!g_spawn_async(NULL, argv, NULL, (GSpawnFlags)(G_SPAWN_SEARCH_PATH | G_SPAWN_DO_NOT_REAP_CHILD),
+                       NULL, NULL, &pid, &err)) {
+        g_print("Failed to apply locale: %s\n", err->message);
+        g_error_free(err);
+        timing_record(aw, "locale_apply", aw->selected_lang, job.apply_started, g_get_monotonic_time(), "failed");
+        journal_end(aw, step, JournalState::Failed);
+        return;
+    }
+    job.applying = true;
+    job.applying_lang = aw->selected_lang;
+    g_child_watch_add(pid, [](GPid pid, gint status, gpointer data) {
+        AppWidgets* aw = (AppWidgets*)data;
+        LocaleGenJob& job = aw->localegen;
+        g_spawn_close_pid(pid);
+        timing_record_child(aw, "locale_apply", job.applying_lang, job.apply_started, status);
+        bool ok = g_spawn_check_exit_status(status, NULL);
+        if (!ok) g_print("update-locale failed\n");
+        job.applying = false;
+        if (ok) job.applied = job.applying_lang;
+        for (size_t i = 0; i < aw->journal.size(); ++i) {
+            if (aw->journal[i].kind == "locale" && aw->journal[i].target == job.applying_lang)
+                journal_end(aw, (int)i, ok ? JournalState::Done : JournalState::Failed);
+        }
+        if (job.apply_pending) {
+            job.apply_pending = false;
+            locale_apply(aw);
+        }
+    }, aw);
+}
+
+// ---------------- Timezone apply ----------------
+// As root the timezone is applied directly on the filesystem (no fork, no
+// D-Bus), so it also works in a chroot while pre-baking images. The wizard
+// normally runs as a user, in which case the same link and file are written
+// through one sudo'd shell. `timedatectl` is only used when
+// SHADOWMITE_TIMEDATECTL is set and systemd is actually running.
+
+static void fsync_dir(const fs::path& dir) {
+    int dfd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dfd >= 0) {
+        fsync(dfd);
+        close(dfd);
+    }
+}
+
+// Write via a temp file + rename so readers never see a torn file. The temp
+// name is unique, so concurrent writers of the same path can't interleave.
+// With `durable` the data and the rename are fsync'd too; caches can skip that.
+static bool write_file_atomic(const fs::path& path, const std::string& contents, bool durable = true) {
+    std::string tmp = path.string() + ".sm-XXXXXX";
+    int fd = mkostemp(&tmp[0], O_CLOEXEC);
+    if (fd < 0) return false;
+    bool ok = fchmod(fd, 0644) == 0 &&
+              write(fd, contents.data(), contents.size()) == (ssize_t)contents.size() &&
+              (!durable || fsync(fd) == 0);
+    close(fd);
+    if (!ok || rename(tmp.c_str(), path.c_str()) != 0) {
+        unlink(tmp.c_str());
+        return false;
+    }
+    if (!durable) return true;
+    // Persist the rename itself
+    fsync_dir(path.parent_path());
+    return true;
+}
+
+static bool systemd_running() {
+    return fs::exists("/run/systemd/system");
+}
+
+// Root writes the link and file itself: a temp link renamed over
+// /etc/localtime, and write_file_atomic for /etc/timezone
+static bool apply_timezone_direct(const std::string& tz, const std::string& target) {
+    const char* tmp_link = "/etc/.localtime.sm-tmp";
+    unlink(tmp_link);
+    if (symlink(target.c_str(), tmp_link) != 0 || rename(tmp_link, "/etc/localtime") != 0) {
+        g_print("Failed to set /etc/localtime: %s\n", strerror(errno));
+        unlink(tmp_link);
+        return false;
+    }
+    fsync_dir("/etc");
+    if (!write_file_atomic("/etc/timezone", tz + "\n")) {
+        g_print("Failed to write /etc/timezone: %s\n", strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+// The same steps as one sudo'd shell, so a password is asked for at most
+// once. The zone and link target are passed as arguments, never spliced into
+// the script.
+static const char* TIMEZONE_SCRIPT =
+    "set -e\n"
+    "ln -sfn \"$1\" /etc/.localtime.sm-tmp\n"
+    "mv -Tf /etc/.localtime.sm-tmp /etc/localtime\n"
+    "printf '%s\\n' \"$2\" > /etc/.timezone.sm-tmp\n"
+    "chmod 0644 /etc/.timezone.sm-tmp\n"
+    "sync /etc/.timezone.sm-tmp\n"
+    "mv -f /etc/.timezone.sm-tmp /etc/timezone\n"
+    "sync /etc\n";
+
+static void timezone_apply(AppWidgets* aw);
+
+static void timezone_apply_done(AppWidgets* aw, bool ok, int exit_code) {
+    TimezoneJob& job = aw->tzjob;
+    job.applying = false;
+    timing_record(aw, "timezone_apply", job.applying_tz, job.started, g_get_monotonic_time(),
+                  ok ? "ok" : "failed", exit_code);
+    if (ok) job.applied = job.applying_tz;
+    else g_print("Failed to set timezone %s\n", job.applying_tz.c_str());
+    journal_end(aw, job.journal_step, ok ? JournalState::Done : JournalState::Failed);
+    if (job.apply_pending) {
+        job.apply_pending = false;
+        timezone_apply(aw);
     }
 }
 
+// Make the selected zone the system's. Runs at most once per choice, however
+// often the finish page is shown; as a user the work happens in a watched
+// child, so a sudo prompt never blocks the window.
+static void timezone_apply(AppWidgets* aw) {
+    const std::string& tz = aw->selected_tz;
+    TimezoneJob& job = aw->tzjob;
+    // A preselected system zone is already in effect
+    if (tz.empty() || !aw->tz_chosen) return;
+    if (job.applying) {
+        if (job.applying_tz != tz) job.apply_pending = true;
+        return;
+    }
+    if (job.applied == tz) return;
+
+    job.applying = true;
+    job.applying_tz = tz;
+    job.journal_step = journal_begin(aw, "timezone", tz, {});
+    job.started = g_get_monotonic_time();
+    if (tz[0] == '/' || tz.find("..") != std::string::npos || !fs::is_regular_file(fs::path(ZONEINFO_DIR) / tz)) {
+        g_print("Unknown timezone: %s\n", tz.c_str());
+        timezone_apply_done(aw, false, -1);
+        return;
+    }
+    std::string target = std::string("..") + ZONEINFO_DIR + "/" + tz;
+
+    std::vector<std::string> args;
+    const char* want_timedatectl = getenv("SHADOWMITE_TIMEDATECTL");
+    if (want_timedatectl && *want_timedatectl && strcmp(want_timedatectl, "0") != 0 && systemd_running()) {
+        args = {"sudo", "timedatectl", "set-timezone", tz};
+    } else if (geteuid() == 0) {
+        timezone_apply_done(aw, apply_timezone_direct(tz, target), -1);
+        return;
+    } else {
+        args = {"sudo", "sh", "-c", TIMEZONE_SCRIPT, "sh", target, tz};
+    }
+
+    std::vector<gchar*> argv;
+    for (const auto& arg : args) argv.push_back((gchar*)arg.c_str());
+    argv.push_back(NULL);
+    GError* err = NULL;
+    GPid pid = 0;
+    if (!g_spawn_async(NULL, argv.data(), NULL, (GSpawnFlags)(G_SPAWN_SEARCH_PATH | G_SPAWN_DO_NOT_REAP_CHILD),
+                       NULL, NULL, &pid, &err)) {
+        g_print("Failed to start %s: %s\n", args[1].c_str(), err->message);
+        g_error_free(err);
+        timezone_apply_done(aw, false, -1);
+        return;
+    }
+    g_child_watch_add(pid, [](GPid pid, gint status, gpointer data) {
+        g_spawn_close_pid(pid);
+        int code = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+        timezone_apply_done((AppWidgets*)data, code == 0, code);
+    }, aw);
+}
+
+// ---------------- Install journal ----------------
+// A write-ahead record of what the wizard is provisioning, kept in
+// ~/sm_conf/journal.json. The locale and timezone are written as pending when
+// picked; every step is written as running before it starts and updated when
+// it ends, each time fsync'd and renamed into place. After a
+// crash or power loss the next launch resumes the incomplete steps instead of
+// starting over at the welcome page.
+static const char* const JOURNAL_STATES[] = {"pending", "running", "done", "failed", "cancelled"};
+
+static fs::path journal_path() {
+    return fs::path(getenv("HOME")) / "sm_conf" / "journal.json";
+}
+
+static void journal_save(AppWidgets* aw) {
+    json steps = json::array();
+    for (const auto& step : aw->journal) {
+        json j;
+        j["kind"] = step.kind;
+        j["state"] = JOURNAL_STATES[(int)step.state];
+        if (!step.target.empty()) j["target"] = step.target;
+        if (!step.items.empty()) {
+            j["items"] = json::array();
+            for (const auto& item : step.items) j["items"].push_back({{"package", item.package}, {"repo", item.repo}});
+        }
+        steps.push_back(j);
+    }
+    json doc;
+    doc["version"] = 1;
+    doc["steps"] = steps;
+
+    fs::path path = journal_path();
+    std::error_code ec;
+    fs::create_directories(path.parent_path(), ec);
+    if (!write_file_atomic(path, doc.dump(2) + "\n")) g_print("Failed to write install journal: %s\n", path.c_str());
+}
+
+static void journal_load(AppWidgets* aw) {
+    std::ifstream ifs(journal_path());
+    if (!ifs.is_open()) return;
+    try {
+        json doc;
+        ifs >> doc;
+        for (const auto& j : doc.at("steps")) {
+            JournalStep step;
+            step.kind = j.at("kind").get<std::string>();
+            step.target = j.value("target", "");
+            std::string state = j.value("state", "pending");
+            step.state = JournalState::Pending;
+            for (int i = 0; i < 5; ++i) {
+                if (state == JOURNAL_STATES[i]) step.state = (JournalState)i;
+            }
+            if (j.contains("items")) {
+                for (const auto& item : j["items"])
+                    step.items.push_back({item.value("package", ""), item.value("repo", "")});
+            }
+            aw->journal.push_back(std::move(step));
+        }
+    } catch (...) {
+        g_print("Ignoring unreadable install journal\n");
+        aw->journal.clear();
+    }
+}
+
+static bool journal_incomplete(const JournalStep& step) {
+    return step.state == JournalState::Pending || step.state == JournalState::Running;
+}
+
+// Record `kind` as running. The locale and timezone have one entry each that
+// is reused; an install reuses an incomplete entry for the same apps (a resume).
+static int journal_begin(AppWidgets* aw, const std::string& kind, const std::string& target,
+                         const std::vector<InstallItem>& items) {
+    int index = -1;
+    for (size_t i = 0; i < aw->journal.size(); ++i) {
+        const JournalStep& step = aw->journal[i];
+        if (step.kind != kind) continue;
+        if (kind != "install") index = (int)i;
+        else if (journal_incomplete(step) && step.items.size() == items.size() &&
+                 std::equal(items.begin(), items.end(), step.items.begin(), [](const InstallItem& a, const InstallItem& b) {
+                     return a.package == b.package && a.repo == b.repo;
+                 })) index = (int)i;
+    }
+    if (index < 0) {
+        aw->journal.push_back({});
+        index = (int)aw->journal.size() - 1;
+    }
+    JournalStep& step = aw->journal[index];
+    if (step.kind == kind && step.target == target && step.state == JournalState::Running) return index;
+    step.kind = kind;
+    step.target = target;
+    step.items = items;
+    step.state = JournalState::Running;
+    journal_save(aw);
+    return index;
+}
+
+// Record a locale or timezone choice as pending as soon as it is made, so a
+// crash during a later install still knows what to apply
+static void journal_plan(AppWidgets* aw, const std::string& kind, const std::string& target) {
+    for (auto& step : aw->journal) {
+        if (step.kind != kind) continue;
+        if (step.target == target && journal_incomplete(step)) return;
+        step.target = target;
+        step.state = JournalState::Pending;
+        journal_save(aw);
+        return;
+    }
+    aw->journal.push_back({kind, target, {}, JournalState::Pending});
+    journal_save(aw);
+}
+
+static void journal_end(AppWidgets* aw, int index, JournalState state) {
+    if (index < 0 || index >= (int)aw->journal.size()) return;
+    aw->journal[index].state = state;
+    journal_save(aw);
+}
+
+// dpkg leaves files in its updates/ directory when it was interrupted
+static bool dpkg_interrupted() {
+    std::error_code ec;
+    fs::directory_iterator it("/var/lib/dpkg/updates", ec);
+    return !ec && it != fs::directory_iterator();
+}
+
+// ---------------- Timing report file ----------------
+// ~/sm_conf/timings.json: the device plus every timed step, in milliseconds
+// since launch, so runs on different boards and SD cards can be compared.
+static std::string read_sysfs_line(const char* path) {
+    std::ifstream ifs(path);
+    std::string line;
+    std::getline(ifs, line);
+    // device-tree strings are NUL-terminated
+    line.erase(std::find(line.begin(), line.end(), '\0'), line.end());
+    while (!line.empty() && isspace((unsigned char)line.back())) line.pop_back();
+    return line;
+}
+
+static void timing_write_report(AppWidgets* aw) {
+    TimingLog& log = aw->timings;
+    std::vector<TimingRecord> records;
+    {
+        std::lock_guard<std::mutex> lock(log.mu);
+        log.write_scheduled = false;
+        records = log.records;
+    }
+    std::stable_sort(records.begin(), records.end(),
+                     [](const TimingRecord& a, const TimingRecord& b) { return a.start < b.start; });
+
+    auto ms = [&](gint64 t) { return (t - log.origin) / 1000.0; };
+    json steps = json::array();
+    for (const auto& rec : records) {
+        json j;
+        j["step"] = rec.step;
+        if (!rec.detail.empty()) j["detail"] = rec.detail;
+        j["start_ms"] = ms(rec.start);
+        j["end_ms"] = ms(rec.end);
+        j["duration_ms"] = (rec.end - rec.start) / 1000.0;
+        j["status"] = rec.status;
+        if (rec.exit_code >= 0) j["exit_code"] = rec.exit_code;
+        steps.push_back(j);
+    }
+    json device;
+    device["hostname"] = g_get_host_name();
+    device["model"] = read_sysfs_line("/proc/device-tree/model");
+    device["sd_name"] = read_sysfs_line("/sys/block/mmcblk0/device/name");
+    device["sd_manfid"] = read_sysfs_line("/sys/block/mmcblk0/device/manfid");
+    device["sd_oemid"] = read_sysfs_line("/sys/block/mmcblk0/device/oemid");
+
+    json doc;
+    doc["version"] = 1;
+    doc["device"] = device;
+    doc["written_ms"] = ms(g_get_monotonic_time());
+    doc["steps"] = steps;
+
+    fs::path path = fs::path(getenv("HOME")) / "sm_conf" / "timings.json";
+    std::error_code ec;
+    fs::create_directories(path.parent_path(), ec);
+    if (!write_file_atomic(path, doc.dump(2) + "\n", false)) g_print("Failed to write timing report: %s\n", path.c_str());
+}
+
 // ---------------- Static IP dialog ----------------
 void show_static_ip_dialog(AppWidgets* aw) {
     GtkWidget* dialog = gtk_dialog_new_with_buttons("Static IP Configuration",
@@ -242,153 +1909,1087 @@ void show_static_ip_dialog(AppWidgets* aw) {
     gtk_grid_attach(GTK_GRID(grid), dns_label, 0, 3, 1, 1);
     gtk_grid_attach(GTK_GRID(grid), dns_entry, 1, 3, 1, 1);
 
-    gtk_widget_show_all(dialog);
+    gtk_widget_show_all(dialog);
+
+    int response = gtk_dialog_run(GTK_DIALOG(dialog));
+    if (response == GTK_RESPONSE_OK) {
+        const char* mode = gtk_combo_box_text_get_active_text(GTK_COMBO_BOX_TEXT(mode_combo));
+        const char* ip   = gtk_entry_get_text(GTK_ENTRY(ip_entry));
+        const char* gw   = gtk_entry_get_text(GTK_ENTRY(gw_entry));
+        const char* dns  = gtk_entry_get_text(GTK_ENTRY(dns_entry));
+        std::cout << "Static IP Config: Mode=" << (mode ? mode : "(null)") << ", IP=" << ip << ", GW=" << gw << ", DNS=" << dns << "\n";
+    }
+    gtk_widget_destroy(dialog);
+}
+
+// ---------------- Paths and file stamps ----------------
+static fs::path apps_dir_path() {
+    return fs::path(getenv("HOME")) / "sm_conf" / "apps";
+}
+
+static bool stamp_file(const fs::path& path, FileStamp& stamp) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) return false;
+    stamp.mtime_ns = (uint64_t)st.st_mtim.tv_sec * 1000000000ull + st.st_mtim.tv_nsec;
+    stamp.size = st.st_size;
+    stamp.inode = st.st_ino;
+    return true;
+}
+
+static fs::path cache_dir_path() {
+    const char* xdg = getenv("XDG_CACHE_HOME");
+    fs::path base = (xdg && *xdg) ? fs::path(xdg) : fs::path(getenv("HOME")) / ".cache";
+    return base / "shadowmite";
+}
+
+// ---------------- Package database ----------------
+// dpkg and apt keep their state in deb822 control files; they are mapped and
+// scanned in place instead of asking `dpkg -s` / `apt-cache` per package.
+static const char* DPKG_STATUS = "/var/lib/dpkg/status";
+
+// Call `fn` once per stanza with the values of the requested fields (empty
+// when absent). A folded field (e.g. a long Depends) keeps its continuation
+// lines, newlines included.
+template <size_t N, typename Fn>
+static void scan_control_file(const char* p, const char* end, const char* const (&names)[N], Fn fn) {
+    std::array<std::string_view, N> values{};
+    bool any = false;
+    size_t last = N;    // field the previous line belonged to
+    while (p < end) {
+        const char* eol = (const char*)memchr(p, '\n', end - p);
+        if (!eol) eol = end;
+        if (eol == p) {
+            // Blank line ends the stanza
+            if (any) fn(values);
+            values = {};
+            any = false;
+            last = N;
+        } else if (*p == ' ' || *p == '\t') {
+            if (last < N) {
+                const char* ve = eol;
+                while (ve > p && (ve[-1] == ' ' || ve[-1] == '\r')) --ve;
+                const char* v = values[last].empty() ? p : values[last].data();
+                if (ve > v) values[last] = std::string_view(v, ve - v);
+            }
+        } else {
+            last = N;
+            const char* colon = (const char*)memchr(p, ':', eol - p);
+            if (colon) {
+                std::string_view name(p, colon - p);
+                for (size_t i = 0; i < N; ++i) {
+                    if (name != names[i]) continue;
+                    const char* v = colon + 1;
+                    while (v < eol && (*v == ' ' || *v == '\t')) ++v;
+                    const char* ve = eol;
+                    while (ve > v && (ve[-1] == ' ' || ve[-1] == '\r')) --ve;
+                    values[i] = std::string_view(v, ve - v);
+                    any = true;
+                    last = i;
+                    break;
+                }
+            }
+        }
+        p = eol + 1;
+    }
+    if (any) fn(values);
+}
+
+// Map `path` and scan it; false if it can't be read or is empty
+template <size_t N, typename Fn>
+static bool scan_control_path(const char* path, const char* const (&names)[N], Fn fn) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return false;
+    }
+    size_t size = st.st_size;
+    void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return false;
+    const char* base = (const char*)map;
+    scan_control_file(base, base + size, names, fn);
+    munmap(map, size);
+    return true;
+}
+
+// "Status: <want> <flag> <state>"; only fully installed packages count
+static bool status_installed(std::string_view status) {
+    size_t sp = status.rfind(' ');
+    return sp != std::string_view::npos && status.substr(sp + 1) == "installed";
+}
+
+static bool read_dpkg_status(const char* path, std::unordered_map<std::string, std::string>& installed) {
+    static const char* const fields[] = {"Package", "Status", "Version"};
+    return scan_control_path(path, fields, [&](const std::array<std::string_view, 3>& f) {
+        if (f[0].empty() || !status_installed(f[1])) return;
+        installed[std::string(f[0])] = std::string(f[2]);
+    });
+}
+
+// Re-read the status file only when it changed; true if the index did
+static bool dpkg_status_refresh(AppWidgets* aw) {
+    DpkgStatusIndex& idx = aw->dpkg_status;
+    FileStamp stamp{};
+    bool present = stamp_file(DPKG_STATUS, stamp);
+    if (idx.loaded && stamp == idx.stamp) return false;
+    idx.installed.clear();
+    if (present) read_dpkg_status(DPKG_STATUS, idx.installed);
+    idx.stamp = stamp;
+    idx.loaded = true;
+    return true;
+}
+
+// A JSON `package` field may name several space-separated packages
+static std::vector<std::string> split_package_names(const std::vector<std::string>& fields) {
+    std::vector<std::string> names;
+    std::unordered_set<std::string> seen;
+    for (const auto& field : fields) {
+        size_t pos = 0;
+        while ((pos = field.find_first_not_of(" \t", pos)) != std::string::npos) {
+            size_t end = field.find_first_of(" \t", pos);
+            std::string name = field.substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+            pos = end;
+            if (seen.insert(name).second) names.push_back(std::move(name));
+        }
+    }
+    return names;
+}
+
+// dpkg's version ordering: epoch, then upstream version and revision compared
+// as alternating non-digit / digit runs, with '~' sorting before anything
+static int deb_char_order(char c) {
+    if (isdigit((unsigned char)c)) return 0;
+    if (isalpha((unsigned char)c)) return c;
+    if (c == '~') return -1;
+    if (c) return c + 256;
+    return 0;
+}
+
+static int deb_verrevcmp(std::string_view a, std::string_view b) {
+    size_t i = 0, j = 0;
+    auto at = [](std::string_view s, size_t k) { return k < s.size() ? s[k] : '\0'; };
+    while (i < a.size() || j < b.size()) {
+        int first_diff = 0;
+        while ((i < a.size() && !isdigit((unsigned char)a[i])) || (j < b.size() && !isdigit((unsigned char)b[j]))) {
+            int ac = deb_char_order(at(a, i));
+            int bc = deb_char_order(at(b, j));
+            if (ac != bc) return ac - bc;
+            ++i;
+            ++j;
+        }
+        while (at(a, i) == '0') ++i;
+        while (at(b, j) == '0') ++j;
+        while (isdigit((unsigned char)at(a, i)) && isdigit((unsigned char)at(b, j))) {
+            if (!first_diff) first_diff = at(a, i) - at(b, j);
+            ++i;
+            ++j;
+        }
+        if (isdigit((unsigned char)at(a, i))) return 1;
+        if (isdigit((unsigned char)at(b, j))) return -1;
+        if (first_diff) return first_diff;
+    }
+    return 0;
+}
+
+static int compare_deb_versions(std::string_view a, std::string_view b) {
+    auto split = [](std::string_view v, long& epoch, std::string_view& upstream, std::string_view& revision) {
+        epoch = 0;
+        size_t colon = v.find(':');
+        if (colon != std::string_view::npos) {
+            epoch = strtol(std::string(v.substr(0, colon)).c_str(), nullptr, 10);
+            v.remove_prefix(colon + 1);
+        }
+        size_t dash = v.rfind('-');
+        upstream = v.substr(0, dash);
+        revision = dash == std::string_view::npos ? std::string_view() : v.substr(dash + 1);
+    };
+    long ea, eb;
+    std::string_view ua, ra, ub, rb;
+    split(a, ea, ua, ra);
+    split(b, eb, ub, rb);
+    if (ea != eb) return ea < eb ? -1 : 1;
+    int r = deb_verrevcmp(ua, ub);
+    return r ? r : deb_verrevcmp(ra, rb);
+}
+
+// apt accepts name:arch; dpkg's status and apt's lists use the bare name
+static std::string bare_package_name(const std::string& name) {
+    return name.substr(0, name.find(':'));
+}
+
+// Every package named by a JSON `package` field is installed
+static bool packages_installed(AppWidgets* aw, const std::string& field) {
+    std::vector<std::string> names = split_package_names({field});
+    for (const auto& name : names) {
+        if (!aw->dpkg_status.installed.count(bare_package_name(name))) return false;
+    }
+    return !names.empty();
+}
+
+// apt keeps one "<source>_Packages" file per configured repository and
+// component. Compressed lists (Acquire::GzipIndexes) are not read.
+static const char* APT_LISTS_DIR = "/var/lib/apt/lists";
+
+static std::vector<std::pair<std::string, FileStamp>> apt_lists_signature() {
+    std::vector<std::pair<std::string, FileStamp>> lists;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(APT_LISTS_DIR, ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.size() < 9 || name.compare(name.size() - 9, 9, "_Packages") != 0) continue;
+        FileStamp stamp;
+        if (stamp_file(entry.path(), stamp)) lists.emplace_back(entry.path().string(), stamp);
+    }
+    std::sort(lists.begin(), lists.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    return lists;
+}
+
+// Several lists may carry the same package; the highest version is the
+// one apt would install
+static void read_apt_list(const std::string& path, std::unordered_map<std::string, AptPackageInfo>& packages) {
+    static const char* const fields[] = {"Package", "Version", "Installed-Size", "Size"};
+    scan_control_path(path.c_str(), fields, [&](const std::array<std::string_view, 4>& f) {
+        if (f[0].empty()) return;
+        auto it = packages.find(std::string(f[0]));
+        if (it != packages.end() && compare_deb_versions(f[1], it->second.version) <= 0) return;
+        AptPackageInfo info;
+        info.version = std::string(f[1]);
+        info.installed_size_kb = strtoull(std::string(f[2]).c_str(), nullptr, 10);
+        info.size = strtoull(std::string(f[3]).c_str(), nullptr, 10);
+        if (it != packages.end()) it->second = std::move(info);
+        else packages.emplace(std::string(f[0]), std::move(info));
+    });
+}
+
+// ---------------- Logo thumbnails ----------------
+// Vendor logos are often 512px or larger. Each one is decoded once per display
+// size and kept as raw pixels under ~/.cache/shadowmite/thumbs, so later
+// loads are a single read with no decoding or scaling.
+//
+// File layout: "SMTH", u32 width, u32 height, u32 has_alpha, source FileStamp,
+// then tightly packed RGB(A) rows.
+static const int LOGO_LIST_SIZE = 48;
+static const int LOGO_SUMMARY_SIZE = 128;
+static const char THUMB_MAGIC[4] = {'S', 'M', 'T', 'H'};
+
+struct ThumbHeader {
+    char magic[4];
+    uint32_t width;
+    uint32_t height;
+    uint32_t has_alpha;
+    FileStamp source;
+};
+
+static fs::path thumbnail_path(const std::string& logo, int size) {
+    char name[64];
+    snprintf(name, sizeof(name), "%016zx-%d.thumb", std::hash<std::string>{}(logo), size);
+    return cache_dir_path() / "thumbs" / name;
+}
+
+static GdkPixbuf* read_thumbnail(const fs::path& path, const FileStamp& source) {
+    std::ifstream ifs(path, std::ios::binary);
+    ThumbHeader h;
+    if (!ifs.read((char*)&h, sizeof(h)) || memcmp(h.magic, THUMB_MAGIC, 4) != 0 || !(h.source == source))
+        return nullptr;
+    if (h.width == 0 || h.height == 0 || h.width > 1024 || h.height > 1024) return nullptr;
+
+    int channels = h.has_alpha ? 4 : 3;
+    size_t stride = (size_t)h.width * channels;
+    guchar* pixels = (guchar*)g_malloc(stride * h.height);
+    if (!ifs.read((char*)pixels, stride * h.height)) {
+        g_free(pixels);
+        return nullptr;
+    }
+    return gdk_pixbuf_new_from_data(pixels, GDK_COLORSPACE_RGB, h.has_alpha, 8, h.width, h.height, stride,
+                                    [](guchar* data, gpointer) { g_free(data); }, nullptr);
+}
+
+static void write_thumbnail(const fs::path& path, GdkPixbuf* pixbuf, const FileStamp& source) {
+    ThumbHeader h;
+    memcpy(h.magic, THUMB_MAGIC, 4);
+    h.width = gdk_pixbuf_get_width(pixbuf);
+    h.height = gdk_pixbuf_get_height(pixbuf);
+    h.has_alpha = gdk_pixbuf_get_has_alpha(pixbuf);
+    h.source = source;
+
+    int channels = gdk_pixbuf_get_n_channels(pixbuf);
+    int rowstride = gdk_pixbuf_get_rowstride(pixbuf);
+    size_t stride = (size_t)h.width * channels;
+    const guint8* pixels = gdk_pixbuf_read_pixels(pixbuf);
+    // Only 8-bit RGB/RGBA is stored; anything else is simply re-decoded next time
+    if (gdk_pixbuf_get_bits_per_sample(pixbuf) != 8 || channels != (h.has_alpha ? 4 : 3)) return;
+
+    std::string buf((const char*)&h, sizeof(h));
+    buf.reserve(sizeof(h) + stride * h.height);
+    for (uint32_t y = 0; y < h.height; ++y) buf.append((const char*)pixels + (size_t)y * rowstride, stride);
+
+    std::error_code ec;
+    fs::create_directories(path.parent_path(), ec);
+    write_file_atomic(path, buf, false);
+}
+
+// Decode with a GdkPixbufLoader so formats that support it (JPEG) scale while
+// decoding; never upscales
+static GdkPixbuf* decode_logo(const std::string& logo, int size, GError** err) {
+    std::ifstream ifs(logo, std::ios::binary);
+    std::string data((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+
+    GdkPixbufLoader* loader = gdk_pixbuf_loader_new();
+    g_signal_connect(loader, "size-prepared", G_CALLBACK(+[](GdkPixbufLoader* l, gint w, gint h, gpointer data) {
+        int size = GPOINTER_TO_INT(data);
+        if (w <= size && h <= size) return;
+        double scale = std::min((double)size / w, (double)size / h);
+        gdk_pixbuf_loader_set_size(l, std::max(1, (int)(w * scale)), std::max(1, (int)(h * scale)));
+    }), GINT_TO_POINTER(size));
+
+    bool ok = gdk_pixbuf_loader_write(loader, (const guchar*)data.data(), data.size(), err);
+    ok = gdk_pixbuf_loader_close(loader, ok ? err : NULL) && ok;
+    GdkPixbuf* pixbuf = ok ? gdk_pixbuf_loader_get_pixbuf(loader) : nullptr;
+    if (pixbuf) g_object_ref(pixbuf);
+    g_object_unref(loader);
+    return pixbuf;
+}
+
+// Returns a new reference scaled to fit size x size, or nullptr. Safe off the main thread.
+static GdkPixbuf* load_logo_thumbnail(const std::string& logo, int size) {
+    FileStamp source;
+    if (logo.empty() || !stamp_file(logo, source)) return nullptr;
+
+    fs::path cached = thumbnail_path(logo, size);
+    if (GdkPixbuf* pixbuf = read_thumbnail(cached, source)) return pixbuf;
+
+    GError* err = NULL;
+    GdkPixbuf* pixbuf = decode_logo(logo, size, &err);
+    if (!pixbuf) {
+        g_print("Failed to load logo %s: %s\n", logo.c_str(), err ? err->message : "unknown error");
+        g_clear_error(&err);
+        return nullptr;
+    }
+    write_thumbnail(cached, pixbuf, source);
+    return pixbuf;
+}
+
+// ---------------- Apps list model ----------------
+// The apps page is a GtkTreeView over a sorted GtkListStore: GTK3's recycling
+// view, which only measures and renders rows inside the viewport. Rows are
+// keyed by catalog id.
+enum { APP_COL_CHECKED, APP_COL_LOGO, APP_COL_TEXT, APP_COL_NAME, APP_COL_ID, APP_N_COLS };
+
+// ---------------- Logo loading (async) ----------------
+// Rows start with the shared default logo; real logos are decoded on a worker
+// and swapped in. Jobs for rows currently in the viewport jump the queue.
+static gboolean logo_flush(gpointer data) {
+    AppWidgets* aw = (AppWidgets*)data;
+    std::vector<LogoResult> done;
+    {
+        std::lock_guard<std::mutex> lock(aw->logo_queue.mu);
+        done.swap(aw->logo_queue.done);
+        aw->logo_queue.flush_scheduled = false;
+    }
+    for (auto& r : done) {
+        // Skip rows that were removed or now point at a different logo
+        const Catalog& cat = aw->catalog;
+        if (r.id < cat.entries.size() && cat.entries[r.id].live && r.logo == catalog_str(cat, cat.entries[r.id].logo))
+            gtk_list_store_set(aw->apps_store, &aw->app_rows[r.id], APP_COL_LOGO, r.pixbuf, -1);
+        g_object_unref(r.pixbuf);
+    }
+    return G_SOURCE_REMOVE;
+}
+
+static void logo_worker(AppWidgets* aw) {
+    LogoQueue& q = aw->logo_queue;
+    for (;;) {
+        LogoJob job;
+        {
+            std::unique_lock<std::mutex> lock(q.mu);
+            q.cv.wait(lock, [&] { return !q.jobs.empty(); });
+            job = std::move(q.jobs.front());
+            q.jobs.pop_front();
+        }
+        GdkPixbuf* pixbuf = load_logo_thumbnail(job.logo, LOGO_LIST_SIZE);
+        if (!pixbuf) continue;
+
+        std::lock_guard<std::mutex> lock(q.mu);
+        q.done.push_back({job.id, std::move(job.logo), pixbuf});
+        if (!q.flush_scheduled) {
+            q.flush_scheduled = true;
+            g_idle_add(logo_flush, aw);
+        }
+    }
+}
+
+static void logo_request(AppWidgets* aw, uint32_t id, const std::string& logo) {
+    LogoQueue& q = aw->logo_queue;
+    {
+        std::lock_guard<std::mutex> lock(q.mu);
+        q.jobs.push_back({id, logo});
+        if (!q.worker_started) {
+            q.worker_started = true;
+            std::thread(logo_worker, aw).detach();
+        }
+    }
+    q.cv.notify_one();
+}
+
+static void logo_queue_clear(AppWidgets* aw) {
+    std::lock_guard<std::mutex> lock(aw->logo_queue.mu);
+    aw->logo_queue.jobs.clear();
+}
+
+// Move jobs for rows inside the scrolled viewport to the front of the queue
+static void logo_prioritize_visible(AppWidgets* aw) {
+    {
+        std::lock_guard<std::mutex> lock(aw->logo_queue.mu);
+        if (aw->logo_queue.jobs.empty()) return;
+    }
+    GtkTreePath* start = NULL;
+    GtkTreePath* end = NULL;
+    if (!gtk_tree_view_get_visible_range(GTK_TREE_VIEW(aw->apps_view), &start, &end)) return;
+    gint first = gtk_tree_path_get_indices(start)[0];
+    gint last = gtk_tree_path_get_indices(end)[0];
+    gtk_tree_path_free(start);
+    gtk_tree_path_free(end);
+
+    std::unordered_set<uint32_t> visible;
+    GtkTreeModel* model = gtk_tree_view_get_model(GTK_TREE_VIEW(aw->apps_view));
+    GtkTreeIter iter;
+    for (gint i = first; i <= last && gtk_tree_model_iter_nth_child(model, &iter, NULL, i); ++i) {
+        guint id = 0;
+        gtk_tree_model_get(model, &iter, APP_COL_ID, &id, -1);
+        visible.insert(id);
+    }
+
+    std::lock_guard<std::mutex> lock(aw->logo_queue.mu);
+    std::stable_partition(aw->logo_queue.jobs.begin(), aw->logo_queue.jobs.end(),
+                          [&](const LogoJob& job) { return visible.count(job.id) > 0; });
+}
+
+// Scrolling fires value-changed many times per frame; the idle runs after
+// the redraw, once
+static void logo_prioritize_schedule(AppWidgets* aw) {
+    if (aw->logo_prioritize_idle) return;
+    aw->logo_prioritize_idle = g_idle_add([](gpointer data) -> gboolean {
+        AppWidgets* aw = (AppWidgets*)data;
+        aw->logo_prioritize_idle = 0;
+        logo_prioritize_visible(aw);
+        return G_SOURCE_REMOVE;
+    }, aw);
+}
+
+// The placeholder is decoded once (through the thumbnail cache) and shared
+static GdkPixbuf* default_logo(AppWidgets* aw) {
+    if (!aw->default_logo && !aw->default_logo_missing) {
+        aw->default_logo = load_logo_thumbnail((apps_dir_path() / "logos/default.png").string(), LOGO_LIST_SIZE);
+        aw->default_logo_missing = !aw->default_logo;
+    }
+    return aw->default_logo;
+}
+
+// ---------------- Apps search ----------------
+// The list view shows a GtkTreeModelFilter over the store; typing only flips
+// per-id visibility computed from the catalog's trigram index, so no row is
+// rebuilt or re-sorted.
+static gboolean app_row_visible(GtkTreeModel* model, GtkTreeIter* iter, gpointer user_data) {
+    AppWidgets* aw = (AppWidgets*)user_data;
+    if (aw->apps_query.empty()) return TRUE;
+    guint id = 0;
+    gtk_tree_model_get(model, iter, APP_COL_ID, &id, -1);
+    return id < aw->apps_visible.size() && aw->apps_visible[id];
+}
+
+// Re-check a single entry after it was added or edited
+static void app_update_visible(AppWidgets* aw, uint32_t id) {
+    if (aw->apps_query.empty()) return;
+    if (aw->apps_visible.size() <= id) aw->apps_visible.resize(id + 1);
+    std::string_view text = aw->catalog.strings.strings[aw->catalog.entries[id].folded];
+    bool match = true;
+    for (const auto& w : aw->apps_query) match = match && text.find(w) != std::string_view::npos;
+    aw->apps_visible[id] = match;
+}
+
+static void apps_apply_filter(AppWidgets* aw, const char* query) {
+    std::string q = query ? query : "";
+    for (auto& c : q) c = (char)tolower((unsigned char)c);
+
+    aw->apps_query.clear();
+    size_t pos = 0;
+    while ((pos = q.find_first_not_of(' ', pos)) != std::string::npos) {
+        size_t end = q.find(' ', pos);
+        aw->apps_query.push_back(q.substr(pos, end == std::string::npos ? std::string::npos : end - pos));
+        pos = end;
+    }
+
+    aw->apps_visible.assign(aw->catalog.entries.size(), 0);
+    if (!aw->apps_query.empty()) {
+        for (uint32_t id : catalog_search(aw->catalog, aw->apps_query)) aw->apps_visible[id] = 1;
+    }
+    if (aw->apps_filter) gtk_tree_model_filter_refilter(GTK_TREE_MODEL_FILTER(aw->apps_filter));
+}
+
+static void apps_search_changed_cb(GtkSearchEntry* entry, gpointer user_data) {
+    apps_apply_filter((AppWidgets*)user_data, gtk_entry_get_text(GTK_ENTRY(entry)));
+}
+
+// ---------------- Apps selection ----------------
+// Rows carry a checkbox; ticked apps are remembered by JSON path so the
+// selection survives edits and reloads, and are installed together.
+static void apps_update_install_button(AppWidgets* aw) {
+    if (!aw->apps_install_btn) return;
+    size_t n = aw->apps_checked.size();
+    std::string label = n ? "Install selected (" + std::to_string(n) + ")" : "Install selected";
+    gtk_button_set_label(GTK_BUTTON(aw->apps_install_btn), label.c_str());
+    // Same rule as install_update_ui: nothing new while one is indexed, running or queued
+    bool running = aw->install.pid > 0 || aw->install.preparing || aw->prefetch.install_pending;
+    gtk_widget_set_sensitive(aw->apps_install_btn, n > 0 && !running);
+}
+
+static void app_toggled_cb(GtkCellRendererToggle* renderer, gchar* path_str, gpointer data) {
+    AppWidgets* aw = (AppWidgets*)data;
+    GtkTreeIter iter;
+    if (!gtk_tree_model_get_iter_from_string(aw->apps_filter, &iter, path_str)) return;
+    guint id = 0;
+    gtk_tree_model_get(aw->apps_filter, &iter, APP_COL_ID, &id, -1);
+    const Catalog& cat = aw->catalog;
+    if (id >= cat.entries.size() || !cat.entries[id].live) return;
+
+    std::string path = catalog_str(cat, cat.entries[id].path);
+    bool checked = !aw->apps_checked.count(path);
+    if (checked) {
+        aw->apps_checked.insert(path);
+        if (!*catalog_str(cat, cat.entries[id].repo)) prefetch_request(aw, catalog_str(cat, cat.entries[id].package));
+    } else {
+        aw->apps_checked.erase(path);
+        prefetch_forget(aw, catalog_str(cat, cat.entries[id].package));
+    }
+    gtk_list_store_set(aw->apps_store, &aw->app_rows[id], APP_COL_CHECKED, (gboolean)checked, -1);
+    apps_update_install_button(aw);
+}
+
+// ---------------- App catalog loading (async) ----------------
+// JSON files are parsed and their logo paths resolved on a small worker pool;
+// parsed entries are handed to the main loop in batches so rows appear
+// progressively instead of stalling the first paint of the Apps page.
+struct CatalogLoad {
+    AppWidgets* aw;
+    guint generation;           // matches aw->catalog_generation unless superseded
+    std::mutex mu;
+    std::vector<AppEntry> pending;
+    bool flush_scheduled;
+    bool finished;
+    bool full_scan;             // the whole directory, not just files the watch saw change
+};
+
+// SAX handler that keeps only the four top-level fields the catalog shows.
+// Everything else (changelogs, screenshot arrays, ...) is validated by the
+// parser but never materialized.
+struct AppJsonSax : nlohmann::json_sax<json> {
+    AppEntry& app;
+    int depth = 0;
+    std::string* target = nullptr;   // field the next top-level value goes to
+    bool have_name = false;
+
+    explicit AppJsonSax(AppEntry& a) : app(a) {}
+
+    // The document must be an object and the wanted keys must hold strings;
+    // returning false aborts the parse
+    bool value_ok() {
+        bool ok = depth > 0 && !target;
+        target = nullptr;
+        return ok;
+    }
 
-    int response = gtk_dialog_run(GTK_DIALOG(dialog));
-    if (response == GTK_RESPONSE_OK) {
-        const char* mode = gtk_combo_box_text_get_active_text(GTK_COMBO_BOX_TEXT(mode_combo));
-        const char* ip   = gtk_entry_get_text(GTK_ENTRY(ip_entry));
-        const char* gw   = gtk_entry_get_text(GTK_ENTRY(gw_entry));
-        const char* dns  = gtk_entry_get_text(GTK_ENTRY(dns_entry));
-        std::cout << "Static IP Config: Mode=" << (mode ? mode : "(null)") << ", IP=" << ip << ", GW=" << gw << ", DNS=" << dns << "\n";
+    bool null() override { return value_ok(); }
+    bool boolean(bool) override { return value_ok(); }
+    bool number_integer(number_integer_t) override { return value_ok(); }
+    bool number_unsigned(number_unsigned_t) override { return value_ok(); }
+    bool number_float(number_float_t, const string_t&) override { return value_ok(); }
+    bool binary(binary_t&) override { return value_ok(); }
+    bool string(string_t& val) override {
+        if (depth == 0) return false;
+        if (target) {
+            if (target == &app.name) have_name = true;
+            *target = std::move(val);
+            target = nullptr;
+        }
+        return true;
     }
-    gtk_widget_destroy(dialog);
-}
+    bool start_object(std::size_t) override {
+        if (depth > 0 && !value_ok()) return false;
+        ++depth;
+        return true;
+    }
+    bool end_object() override {
+        --depth;
+        return true;
+    }
+    bool start_array(std::size_t) override {
+        if (!value_ok()) return false;
+        ++depth;
+        return true;
+    }
+    bool end_array() override {
+        --depth;
+        return true;
+    }
+    bool key(string_t& val) override {
+        if (depth != 1) return true;
+        if (val == "name") target = &app.name;
+        else if (val == "description") target = &app.description;
+        else if (val == "logo") target = &app.logo;
+        else if (val == "package") target = &app.package;
+        else if (val == "repo") target = &app.repo;
+        return true;
+    }
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&) override {
+        return false;
+    }
+};
 
-// --- Callback for "Continue" buttons ---
-static void continue_btn_clicked(GtkButton* btn, gpointer data) {
-    auto tup = static_cast<std::tuple<
-        AppWidgets*, std::string, std::string, std::string, std::string, fs::path
-    >*>(data);
+static bool parse_app_json(const fs::path& path, AppEntry& app) {
+    // Stamp before reading, so a write racing with the parse invalidates it
+    if (!stamp_file(path, app.stamp)) return false;
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return false;
+    }
+    size_t size = st.st_size;
+    void* map = size ? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+
+    app.name.clear();
+    app.description.clear();
+    app.logo.clear();
+    app.package.clear();
+    app.repo.clear();
+    bool ok = false;
+    if (map != MAP_FAILED) {
+        const char* text = (const char*)map;
+        AppJsonSax sax(app);
+        ok = json::sax_parse(text, text + size, &sax);
+        if (ok && !sax.have_name) app.name = path.stem().string();
+        munmap(map, size);
+    }
+    if (!ok) {
+        g_print("Failed to parse JSON: %s\n", path.c_str());
+        return false;
+    }
+    app.path = path;
+
+    // Expand ~ to $HOME in logo and repo paths
+    const char* home = getenv("HOME");
+    for (std::string* p : {&app.logo, &app.repo}) {
+        if (!p->empty() && (*p)[0] == '~' && home) *p = std::string(home) + p->substr(1);
+        // Make relative paths point to same folder as JSON
+        if (!p->empty() && (*p)[0] != '/') *p = (path.parent_path() / *p).string();
+    }
+    return true;
+}
 
-    AppWidgets* aw;
-    std::string name, description, logo, package;
-    fs::path path;
+// Fall back to the default logo when the named one doesn't exist (yet). Done
+// at load time rather than stored, so a logo added later is picked up.
+static void resolve_app_logo(AppEntry& app) {
+    std::error_code ec;
+    if (!fs::exists(app.logo, ec)) app.logo = (app.path.parent_path() / "logos/default.png").string();
+}
 
-    std::tie(aw, name, description, logo, package, path) = *tup;
-    show_summary(aw, name, description, logo, package, path);
+// Fill the row of catalog entry `id`; `prev_logo` is the interned logo the row
+// showed before, or -1 for a new row
+static void set_app_row(AppWidgets* aw, uint32_t id, int64_t prev_logo) {
+    const Catalog& cat = aw->catalog;
+    const CatalogEntry& e = cat.entries[id];
+    const char* badge = packages_installed(aw, catalog_str(cat, e.package)) ? "Installed" : "Not installed";
+    gchar* text = g_markup_printf_escaped("<b>%s</b>  <small><i>%s</i></small>\n<small>%s</small>",
+                                          catalog_str(cat, e.name), badge, catalog_str(cat, e.description));
+    gtk_list_store_set(aw->apps_store, &aw->app_rows[id],
+                       APP_COL_CHECKED, (gboolean)aw->apps_checked.count(catalog_str(cat, e.path)),
+                       APP_COL_TEXT, text,
+                       APP_COL_NAME, catalog_str(cat, e.name),
+                       APP_COL_ID, (guint)id, -1);
+    g_free(text);
+
+    // Logo: shared placeholder now, the real one once the worker decodes it.
+    // An edit that keeps the same logo keeps the already decoded pixbuf.
+    if (prev_logo == e.logo) return;
+    gtk_list_store_set(aw->apps_store, &aw->app_rows[id], APP_COL_LOGO, default_logo(aw), -1);
+    std::string logo = catalog_str(cat, e.logo);
+    if (!logo.empty() && logo != (apps_dir_path() / "logos/default.png").string())
+        logo_request(aw, id, logo);
 }
 
-// --- Function to load prescribed apps ---
-void load_prescribed_apps(AppWidgets* aw) {
-    // Remove existing children from list box
-    if (aw->apps_list_box) {
-        GList* children = gtk_container_get_children(GTK_CONTAINER(aw->apps_list_box));
-        for (GList* iter = children; iter != nullptr; iter = iter->next) {
-            gtk_widget_destroy(GTK_WIDGET(iter->data));
-        }
-        g_list_free(children);
+// Re-badge every row after dpkg's status file changed (e.g. an install)
+static void refresh_installed_badges(AppWidgets* aw) {
+    if (!dpkg_status_refresh(aw)) return;
+    for (uint32_t id = 0; id < aw->catalog.entries.size(); ++id) {
+        if (aw->catalog.entries[id].live) set_app_row(aw, id, aw->catalog.entries[id].logo);
     }
+}
 
-    // Ensure apps directory exists
-    fs::path apps_dir = fs::path(getenv("HOME")) / "sm_conf" / "apps";
-    if (!fs::exists(apps_dir)) {
-        fs::create_directories(apps_dir);
+// Main thread: turn whatever the workers have parsed so far into rows
+static gboolean catalog_flush(gpointer arg) {
+    auto* load = (std::shared_ptr<CatalogLoad>*)arg;
+    AppWidgets* aw = (*load)->aw;
+
+    std::vector<AppEntry> batch;
+    bool finished, full_scan;
+    {
+        std::lock_guard<std::mutex> lock((*load)->mu);
+        batch.swap((*load)->pending);
+        (*load)->flush_scheduled = false;
+        finished = (*load)->finished;
+        full_scan = (*load)->full_scan;
     }
 
-    // Track added JSON files to avoid duplicates
-    std::unordered_set<std::string> added;
+    if ((*load)->generation == aw->catalog_generation) {
+        for (auto& app : batch) {
+            // The worker opened it, so it existed then; a DELETED event since
+            // means the parse is stale
+            if (aw->catalog_removed.count(app.path.string())) continue;
+
+            // An edited app updates its existing row in place. A full load
+            // (launch or Reload) re-reads every logo, e.g. a new default.png.
+            int64_t prev = catalog_find(aw->catalog, app.path.string());
+            int64_t prev_logo = prev >= 0 && !full_scan ? (int64_t)aw->catalog.entries[prev].logo : -1;
+            uint32_t id = catalog_put(aw->catalog, app);
+            app_update_visible(aw, id);
+            if (prev < 0) {
+                if (aw->app_rows.size() <= id) aw->app_rows.resize(id + 1);
+                gtk_list_store_append(aw->apps_store, &aw->app_rows[id]);
+            }
+            if (aw->catalog_seen.size() <= id) aw->catalog_seen.resize(id + 1);
+            aw->catalog_seen[id] = 1;
+            set_app_row(aw, id, prev_logo);
+        }
+        // The first screen gets its logos first without waiting for a scroll
+        if (!batch.empty()) logo_prioritize_schedule(aw);
+        if (finished && full_scan) {
+            // Rows kept across a Reload whose JSON is gone; their ticks go too
+            const Catalog& cat = aw->catalog;
+            for (uint32_t id = 0; id < cat.entries.size(); ++id) {
+                if (cat.entries[id].live && !(id < aw->catalog_seen.size() && aw->catalog_seen[id]))
+                    remove_app_row(aw, catalog_str(cat, cat.entries[id].path));
+            }
+        }
+        catalog_compact(aw->catalog);
+        if (finished && aw->status_label) gtk_label_set_text(GTK_LABEL(aw->status_label), "");
+    }
+    delete load;
+    return G_SOURCE_REMOVE;
+}
 
-    for (auto& entry : fs::directory_iterator(apps_dir)) {
-        if (entry.path().extension() != ".json") continue;
+static void catalog_schedule_flush(const std::shared_ptr<CatalogLoad>& load) {
+    // Caller holds load->mu
+    if (load->flush_scheduled) return;
+    load->flush_scheduled = true;
+    g_idle_add(catalog_flush, new std::shared_ptr<CatalogLoad>(load));
+}
 
-        std::string pstr = entry.path().string();
-        if (added.find(pstr) != added.end()) continue;
-        added.insert(pstr);
+// Parse `files` on the worker pool; parsed entries are also copied to `parsed` if given
+static void catalog_parse_files(std::shared_ptr<CatalogLoad> load, std::vector<fs::path> files,
+                                std::vector<AppEntry>* parsed = nullptr) {
+    std::atomic<size_t> next{0};
+    auto work = [&]() {
+        for (size_t i = next++; i < files.size(); i = next++) {
+            AppEntry app;
+            if (!parse_app_json(files[i], app)) continue;
+            AppEntry shown = app;
+            resolve_app_logo(shown);
+            std::lock_guard<std::mutex> lock(load->mu);
+            if (parsed) parsed->push_back(std::move(app));
+            load->pending.push_back(std::move(shown));
+            catalog_schedule_flush(load);
+        }
+    };
 
-        std::ifstream ifs(entry.path());
-        if (!ifs.is_open()) continue;
+    unsigned n_workers = std::max(1u, std::min(4u, std::thread::hardware_concurrency()));
+    std::vector<std::thread> helpers;
+    for (unsigned i = 1; i < n_workers && i < files.size(); ++i) helpers.emplace_back(work);
+    work();
+    for (auto& t : helpers) t.join();
 
-        try {
-            json j;
-            ifs >> j;
+    std::lock_guard<std::mutex> lock(load->mu);
+    load->finished = true;
+    catalog_schedule_flush(load);
+}
 
-            std::string name        = j.value("name", entry.path().stem().string());
-            std::string description = j.value("description", "");
-            std::string logo        = j.value("logo", "");
-            std::string package     = j.value("package", "");
+// ---------------- App catalog index ----------------
+// Parsed entries are cached in ~/.cache/shadowmite/catalog.idx together with
+// each JSON's stamp, so a launch only re-parses files that actually changed.
+// The logo is stored as written (only ~ and relative paths expanded); the
+// default-logo fallback is re-checked on every load.
+//
+// Layout (native endianness, it never leaves the device):
+//   "SMCI" u32 version, u32 count
+//   count x { u64 mtime_ns, u64 size, u64 inode,
+//             6 x (u32 length, bytes) for path, name, description, logo, package, repo }
+static const char CATALOG_INDEX_MAGIC[4] = {'S', 'M', 'C', 'I'};
+static const uint32_t CATALOG_INDEX_VERSION = 3;
+
+static fs::path catalog_index_path() {
+    return cache_dir_path() / "catalog.idx";
+}
 
-            // Expand ~ to $HOME in logo path
-            if (!logo.empty() && logo[0] == '~') {
-                const char* home = getenv("HOME");
-                if (home) {
-                    logo = std::string(home) + logo.substr(1);
+static std::unordered_map<std::string, AppEntry> read_catalog_index(const fs::path& path) {
+    std::unordered_map<std::string, AppEntry> index;
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return index;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < 12) {
+        close(fd);
+        return index;
+    }
+    size_t size = st.st_size;
+    void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return index;
+
+    const char* p = (const char*)map;
+    const char* end = p + size;
+    auto read_u32 = [&](uint32_t& v) {
+        if (end - p < 4) return false;
+        memcpy(&v, p, 4);
+        p += 4;
+        return true;
+    };
+    auto read_u64 = [&](uint64_t& v) {
+        if (end - p < 8) return false;
+        memcpy(&v, p, 8);
+        p += 8;
+        return true;
+    };
+    auto read_str = [&](std::string& v) {
+        uint32_t len;
+        if (!read_u32(len) || (size_t)(end - p) < len) return false;
+        v.assign(p, len);
+        p += len;
+        return true;
+    };
+
+    uint32_t version = 0, count = 0;
+    if (memcmp(p, CATALOG_INDEX_MAGIC, 4) == 0) {
+        p += 4;
+        if (read_u32(version) && version == CATALOG_INDEX_VERSION && read_u32(count)) {
+            for (uint32_t i = 0; i < count; ++i) {
+                AppEntry app;
+                std::string app_path;
+                if (!read_u64(app.stamp.mtime_ns) || !read_u64(app.stamp.size) || !read_u64(app.stamp.inode) ||
+                    !read_str(app_path) || !read_str(app.name) || !read_str(app.description) ||
+                    !read_str(app.logo) || !read_str(app.package) || !read_str(app.repo)) {
+                    index.clear();  // truncated: distrust the whole file
+                    break;
                 }
+                app.path = app_path;
+                index.emplace(std::move(app_path), std::move(app));
             }
-            // Make relative logos point to same folder as JSON
-            if (!logo.empty() && logo[0] != '/') {
-                logo = (entry.path().parent_path() / logo).string();
-            }
-            // Fallback to default logo
-            if (!fs::exists(logo)) {
-                logo = (entry.path().parent_path() / "logos/default.png").string();
-            }
+        }
+    }
+    munmap(map, size);
+    return index;
+}
+
+static void write_catalog_index(const fs::path& path, const std::vector<AppEntry>& apps) {
+    std::string buf(CATALOG_INDEX_MAGIC, 4);
+    auto put_u32 = [&](uint32_t v) { buf.append((const char*)&v, 4); };
+    auto put_u64 = [&](uint64_t v) { buf.append((const char*)&v, 8); };
+    auto put_str = [&](const std::string& v) { put_u32((uint32_t)v.size()); buf += v; };
+
+    put_u32(CATALOG_INDEX_VERSION);
+    put_u32((uint32_t)apps.size());
+    for (auto& app : apps) {
+        put_u64(app.stamp.mtime_ns);
+        put_u64(app.stamp.size);
+        put_u64(app.stamp.inode);
+        put_str(app.path.string());
+        put_str(app.name);
+        put_str(app.description);
+        put_str(app.logo);
+        put_str(app.package);
+        put_str(app.repo);
+    }
 
-            // Build a row for this app
-            GtkWidget* row = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 10);
+    std::error_code ec;
+    fs::create_directories(path.parent_path(), ec);
+    if (!write_file_atomic(path, buf)) g_print("Failed to write catalog index: %s\n", path.c_str());
+}
 
-            // App logo
-            GtkWidget* image = nullptr;
-            if (fs::exists(logo)) {
-                image = gtk_image_new_from_file(logo.c_str());
-            } else {
-                image = gtk_image_new(); // empty placeholder
-            }
-            gtk_box_pack_start(GTK_BOX(row), image, FALSE, FALSE, 10);
+static void catalog_load_thread(std::shared_ptr<CatalogLoad> load, fs::path apps_dir) {
+    gint64 start = g_get_monotonic_time();
+    {
+        std::lock_guard<std::mutex> lock(load->mu);
+        load->full_scan = true;
+    }
+    fs::path index_path = catalog_index_path();
+    auto index = read_catalog_index(index_path);
+
+    // Stat sweep: unchanged files come straight from the index
+    std::vector<AppEntry> current;
+    std::vector<fs::path> stale;
+    std::error_code ec;
+    for (auto& entry : fs::directory_iterator(apps_dir, ec)) {
+        if (entry.path().extension() != ".json") continue;
+        FileStamp stamp;
+        if (!stamp_file(entry.path(), stamp)) continue;
+        auto it = index.find(entry.path().string());
+        if (it != index.end() && it->second.stamp == stamp) current.push_back(std::move(it->second));
+        else stale.push_back(entry.path());
+    }
+    if (!current.empty()) {
+        std::vector<AppEntry> shown = current;
+        for (auto& app : shown) resolve_app_logo(app);
+        std::lock_guard<std::mutex> lock(load->mu);
+        load->pending.insert(load->pending.end(), std::make_move_iterator(shown.begin()),
+                             std::make_move_iterator(shown.end()));
+        catalog_schedule_flush(load);
+    }
 
-            // Labels (name + description)
-            GtkWidget* vbox = gtk_box_new(GTK_ORIENTATION_VERTICAL, 4);
+    bool dirty = !stale.empty() || current.size() != index.size();
+    size_t parsed = stale.size();
+    catalog_parse_files(load, std::move(stale), &current);
+    if (dirty) write_catalog_index(index_path, current);
+    timing_record(load->aw, "catalog_load",
+                  std::to_string(current.size()) + " apps, " + std::to_string(parsed) + " parsed",
+                  start, g_get_monotonic_time(), "ok");
+}
+
+static std::shared_ptr<CatalogLoad> catalog_new_load(AppWidgets* aw) {
+    auto load = std::make_shared<CatalogLoad>();
+    load->aw = aw;
+    load->generation = aw->catalog_generation;
+    load->flush_scheduled = false;
+    load->finished = false;
+    load->full_scan = false;
+    return load;
+}
 
-            GtkWidget* label_name = gtk_label_new(name.c_str());
-            gtk_widget_set_name(label_name, "app-name");
-            gtk_widget_set_halign(label_name, GTK_ALIGN_START);
-            gtk_label_set_xalign(GTK_LABEL(label_name), 0.0);
+// ---------------- App catalog watching ----------------
+// ~/sm_conf/apps is watched with a GFileMonitor (inotify) so edits only touch
+// the affected rows. Bursts of events are coalesced before re-parsing.
+static void remove_app_row(AppWidgets* aw, const std::string& path) {
+    int64_t id = catalog_find(aw->catalog, path);
+    if (id < 0) return;
+    std::string package = catalog_str(aw->catalog, aw->catalog.entries[id].package);
+    gtk_list_store_remove(aw->apps_store, &aw->app_rows[id]);
+    catalog_erase(aw->catalog, id);
+    // A dropped tick also stops downloading what only it needed
+    if (aw->apps_checked.erase(path)) {
+        prefetch_forget(aw, package);
+        apps_update_install_button(aw);
+    }
+}
 
-            GtkWidget* label_desc = gtk_label_new(description.c_str());
-            gtk_widget_set_name(label_desc, "app-desc");
-            gtk_label_set_xalign(GTK_LABEL(label_desc), 0.0);
-            gtk_label_set_xalign(GTK_LABEL(label_desc), 0.0);
-            gtk_label_set_justify(GTK_LABEL(label_desc), GTK_JUSTIFY_LEFT);
+static gboolean catalog_dirty_flush(gpointer data) {
+    AppWidgets* aw = (AppWidgets*)data;
+    aw->catalog_dirty_timer = 0;
+    std::vector<fs::path> files(aw->catalog_dirty.begin(), aw->catalog_dirty.end());
+    aw->catalog_dirty.clear();
+    std::thread(catalog_parse_files, catalog_new_load(aw), std::move(files), nullptr).detach();
+    return G_SOURCE_REMOVE;
+}
 
-            gtk_box_pack_start(GTK_BOX(vbox), label_name, FALSE, FALSE, 0);
-            gtk_box_pack_start(GTK_BOX(vbox), label_desc, FALSE, FALSE, 0);
-            gtk_box_pack_start(GTK_BOX(row), vbox, TRUE, TRUE, 10);
+static void catalog_mark_dirty(AppWidgets* aw, GFile* file) {
+    char* path = g_file_get_path(file);
+    if (!path) return;
+    if (fs::path(path).extension() == ".json") {
+        aw->catalog_dirty.insert(path);
+        aw->catalog_removed.erase(path);
+        if (!aw->catalog_dirty_timer) aw->catalog_dirty_timer = g_timeout_add(50, catalog_dirty_flush, aw);
+    }
+    g_free(path);
+}
 
-            // Continue button
-            GtkWidget* cont_btn = gtk_button_new_with_label("Continue");
-            auto* tup = new std::tuple<
-                AppWidgets*, std::string, std::string, std::string, std::string, fs::path
-            >(aw, name, description, logo, package, entry.path());
+static void catalog_mark_removed(AppWidgets* aw, GFile* file) {
+    char* path = g_file_get_path(file);
+    if (!path) return;
+    aw->catalog_dirty.erase(path);
+    aw->catalog_removed.insert(path);
+    remove_app_row(aw, path);
+    g_free(path);
+}
 
-            g_signal_connect_data(
-                cont_btn,
-                "clicked",
-                G_CALLBACK(continue_btn_clicked),
-                tup,
-                [](gpointer data, GClosure*) {
-                    delete static_cast<std::tuple<
-                        AppWidgets*, std::string, std::string, std::string, std::string, fs::path
-                    >*>(data);
-                },
-                (GConnectFlags)0
-            );
+static void apps_dir_changed_cb(GFileMonitor* monitor, GFile* file, GFile* other,
+                                GFileMonitorEvent event, gpointer user_data) {
+    AppWidgets* aw = (AppWidgets*)user_data;
+    switch (event) {
+    case G_FILE_MONITOR_EVENT_CREATED:
+    case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
+    case G_FILE_MONITOR_EVENT_MOVED_IN:
+        catalog_mark_dirty(aw, file);
+        break;
+    case G_FILE_MONITOR_EVENT_DELETED:
+    case G_FILE_MONITOR_EVENT_MOVED_OUT:
+        catalog_mark_removed(aw, file);
+        break;
+    case G_FILE_MONITOR_EVENT_RENAMED:
+        // Editors that save atomically rename a temp file over the JSON
+        catalog_mark_removed(aw, file);
+        if (other) catalog_mark_dirty(aw, other);
+        break;
+    default:
+        break;
+    }
+}
 
-            gtk_box_pack_end(GTK_BOX(row), cont_btn, FALSE, FALSE, 10);
+static void catalog_watch(AppWidgets* aw, const fs::path& apps_dir) {
+    if (aw->apps_monitor) return;
+    GFile* dir = g_file_new_for_path(apps_dir.c_str());
+    GError* err = NULL;
+    aw->apps_monitor = g_file_monitor_directory(dir, G_FILE_MONITOR_WATCH_MOVES, NULL, &err);
+    g_object_unref(dir);
+    if (!aw->apps_monitor) {
+        g_print("Failed to watch %s: %s\n", apps_dir.c_str(), err->message);
+        g_error_free(err);
+        return;
+    }
+    g_signal_connect(aw->apps_monitor, "changed", G_CALLBACK(apps_dir_changed_cb), aw);
+}
 
-            // Add row to list box
-            gtk_box_pack_start(GTK_BOX(aw->apps_list_box), row, FALSE, FALSE, 8);
+// --- Function to load prescribed apps ---
+// A Reload keeps the existing rows and catalog entries: the full load updates
+// them in place and drops the ones it didn't deliver once it finishes.
+void load_prescribed_apps(AppWidgets* aw) {
+    // Every logo is requested again as the load delivers its row
+    logo_queue_clear(aw);
+    // A default.png added since is picked up by a Reload
+    aw->default_logo_missing = false;
 
-        } catch (...) {
-            g_print("Failed to parse JSON: %s\n", entry.path().c_str());
-        }
+    // Ensure apps directory exists
+    fs::path apps_dir = apps_dir_path();
+    if (!fs::exists(apps_dir)) {
+        fs::create_directories(apps_dir);
     }
 
-    gtk_widget_show_all(aw->apps_list_box);
+    catalog_watch(aw, apps_dir);
+    dpkg_status_refresh(aw);
+
+    // Any load still in flight for an older generation just drops its results
+    ++aw->catalog_generation;
+    aw->catalog_removed.clear();
+    aw->catalog_seen.assign(aw->catalog.entries.size(), 0);
+    if (aw->status_label) gtk_label_set_text(GTK_LABEL(aw->status_label), "Loading apps\u2026");
+    std::thread(catalog_load_thread, catalog_new_load(aw), apps_dir).detach();
 }
 
 void reload_prescribed_apps(AppWidgets* aw) {
     load_prescribed_apps(aw);
-    gtk_widget_show_all(aw->apps_list_box);
+}
+
+static void app_row_activated_cb(GtkTreeView* view, GtkTreePath* path, GtkTreeViewColumn* column, gpointer data) {
+    AppWidgets* aw = (AppWidgets*)data;
+    // A click on the checkbox toggles it rather than opening the summary
+    if (column == gtk_tree_view_get_column(view, 0)) return;
+    GtkTreeModel* model = gtk_tree_view_get_model(view);
+    GtkTreeIter iter;
+    if (!gtk_tree_model_get_iter(model, &iter, path)) return;
+    guint id = 0;
+    gtk_tree_model_get(model, &iter, APP_COL_ID, &id, -1);
+    const Catalog& cat = aw->catalog;
+    if (id >= cat.entries.size() || !cat.entries[id].live) return;
+    const CatalogEntry& e = cat.entries[id];
+    show_summary(aw, catalog_str(cat, e.name), catalog_str(cat, e.description), catalog_str(cat, e.logo),
+                 catalog_str(cat, e.package), catalog_str(cat, e.path));
 }
 
 // ---------------- Build UI screens ----------------
@@ -524,26 +3125,62 @@ void setup_locale_screen(AppWidgets* aw) {
     gtk_widget_set_halign(locale_label, GTK_ALIGN_START);
     gtk_box_pack_start(GTK_BOX(vbox), locale_label, FALSE, FALSE, 2);
 
-    aw->locale_combo = gtk_combo_box_text_new();
-    for (auto& loc : get_locales()) {
-        gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(aw->locale_combo), loc.c_str());
-    }
-    gtk_box_pack_start(GTK_BOX(vbox), aw->locale_combo, FALSE, FALSE, 2);
-    if (gtk_combo_box_get_active(GTK_COMBO_BOX(aw->locale_combo)) == -1)
-        gtk_combo_box_set_active(GTK_COMBO_BOX(aw->locale_combo), 0);
+    aw->locale_search = gtk_search_entry_new();
+    gtk_entry_set_placeholder_text(GTK_ENTRY(aw->locale_search), "Search language, country or code");
+    gtk_box_pack_start(GTK_BOX(vbox), aw->locale_search, FALSE, FALSE, 2);
+
+    aw->locale_store = gtk_tree_store_new(LOC_N_COLS, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_INT);
+    aw->locale_filter = gtk_tree_model_filter_new(GTK_TREE_MODEL(aw->locale_store), NULL);
+    gtk_tree_model_filter_set_visible_func(GTK_TREE_MODEL_FILTER(aw->locale_filter), locale_row_visible, aw, NULL);
+
+    aw->locale_view = gtk_tree_view_new_with_model(aw->locale_filter);
+    gtk_tree_view_set_headers_visible(GTK_TREE_VIEW(aw->locale_view), FALSE);
+    gtk_tree_view_set_enable_search(GTK_TREE_VIEW(aw->locale_view), FALSE);
+    GtkTreeViewColumn* loc_col = gtk_tree_view_column_new_with_attributes(
+        "Language", gtk_cell_renderer_text_new(), "text", LOC_COL_LABEL, NULL);
+    gtk_tree_view_column_set_sizing(loc_col, GTK_TREE_VIEW_COLUMN_FIXED);
+    gtk_tree_view_column_set_expand(loc_col, TRUE);
+    gtk_tree_view_append_column(GTK_TREE_VIEW(aw->locale_view), loc_col);
+    GtkTreeViewColumn* note_col = gtk_tree_view_column_new_with_attributes(
+        "Status", gtk_cell_renderer_text_new(), "text", LOC_COL_NOTE, NULL);
+    gtk_tree_view_column_set_sizing(note_col, GTK_TREE_VIEW_COLUMN_FIXED);
+    gtk_tree_view_column_set_fixed_width(note_col, 120);
+    gtk_tree_view_append_column(GTK_TREE_VIEW(aw->locale_view), note_col);
+    gtk_tree_view_set_fixed_height_mode(GTK_TREE_VIEW(aw->locale_view), TRUE);
+
+    GtkWidget* locale_scroll = gtk_scrolled_window_new(NULL, NULL);
+    gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(locale_scroll), GTK_POLICY_NEVER, GTK_POLICY_AUTOMATIC);
+    gtk_widget_set_size_request(locale_scroll, -1, 150);
+    gtk_container_add(GTK_CONTAINER(locale_scroll), aw->locale_view);
+    gtk_box_pack_start(GTK_BOX(vbox), locale_scroll, TRUE, TRUE, 2);
 
     // --- Timezone ---
     GtkWidget* tz_label = gtk_label_new("Timezone:");
     gtk_widget_set_halign(tz_label, GTK_ALIGN_START);
     gtk_box_pack_start(GTK_BOX(vbox), tz_label, FALSE, FALSE, 2);
 
-    aw->tz_combo = gtk_combo_box_text_new();
-    for (auto& tz : get_timezones()) {
-        gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(aw->tz_combo), tz.c_str());
-    }
-    gtk_box_pack_start(GTK_BOX(vbox), aw->tz_combo, FALSE, FALSE, 2);
-    if (gtk_combo_box_get_active(GTK_COMBO_BOX(aw->tz_combo)) == -1)
-        gtk_combo_box_set_active(GTK_COMBO_BOX(aw->tz_combo), 0);
+    aw->tz_search = gtk_search_entry_new();
+    gtk_entry_set_placeholder_text(GTK_ENTRY(aw->tz_search), "Search city or region");
+    gtk_box_pack_start(GTK_BOX(vbox), aw->tz_search, FALSE, FALSE, 2);
+
+    aw->tz_store = gtk_tree_store_new(TZ_N_COLS, G_TYPE_STRING, G_TYPE_INT);
+    aw->tz_filter = gtk_tree_model_filter_new(GTK_TREE_MODEL(aw->tz_store), NULL);
+    gtk_tree_model_filter_set_visible_func(GTK_TREE_MODEL_FILTER(aw->tz_filter), tz_row_visible, aw, NULL);
+
+    aw->tz_view = gtk_tree_view_new_with_model(aw->tz_filter);
+    gtk_tree_view_set_headers_visible(GTK_TREE_VIEW(aw->tz_view), FALSE);
+    gtk_tree_view_set_enable_search(GTK_TREE_VIEW(aw->tz_view), FALSE);
+    GtkTreeViewColumn* tz_col = gtk_tree_view_column_new_with_attributes(
+        "Timezone", gtk_cell_renderer_text_new(), "text", TZ_COL_LABEL, NULL);
+    gtk_tree_view_column_set_sizing(tz_col, GTK_TREE_VIEW_COLUMN_FIXED);
+    gtk_tree_view_append_column(GTK_TREE_VIEW(aw->tz_view), tz_col);
+    gtk_tree_view_set_fixed_height_mode(GTK_TREE_VIEW(aw->tz_view), TRUE);
+
+    GtkWidget* tz_scroll = gtk_scrolled_window_new(NULL, NULL);
+    gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(tz_scroll), GTK_POLICY_NEVER, GTK_POLICY_AUTOMATIC);
+    gtk_widget_set_size_request(tz_scroll, -1, 150);
+    gtk_container_add(GTK_CONTAINER(tz_scroll), aw->tz_view);
+    gtk_box_pack_start(GTK_BOX(vbox), tz_scroll, TRUE, TRUE, 2);
 
     // --- Bottom buttons ---
     GtkWidget* button_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 10);
@@ -557,24 +3194,808 @@ void setup_locale_screen(AppWidgets* aw) {
     g_signal_connect(back_btn, "clicked", G_CALLBACK(back_to_network_cb), aw);
     g_signal_connect(next_btn, "clicked", G_CALLBACK(+[](GtkButton*, gpointer data){
         AppWidgets* aw = (AppWidgets*)data;
-        gtk_stack_set_visible_child_name(GTK_STACK(aw->stack), "apps");
+        show_page(aw, "apps");
     }), aw);
 
-    g_signal_connect(aw->locale_combo, "changed", G_CALLBACK(locale_changed_cb), aw);
-    g_signal_connect(aw->tz_combo, "changed", G_CALLBACK(tz_changed_cb), aw);
+    g_signal_connect(gtk_tree_view_get_selection(GTK_TREE_VIEW(aw->locale_view)), "changed",
+                     G_CALLBACK(locale_selection_changed_cb), aw);
+    g_signal_connect(aw->locale_search, "search-changed", G_CALLBACK(locale_search_changed_cb), aw);
+    g_signal_connect(gtk_tree_view_get_selection(GTK_TREE_VIEW(aw->tz_view)), "changed",
+                     G_CALLBACK(tz_selection_changed_cb), aw);
+    g_signal_connect(aw->tz_search, "search-changed", G_CALLBACK(tz_search_changed_cb), aw);
+
+    // Lists come from the enumeration worker; shows a placeholder until then
+    fill_locale_picker(aw);
+    fill_tz_picker(aw);
+}
+
+// ---------------- Local package repositories ----------------
+// An app JSON may name a "repo": a directory of .deb files (on the boot
+// partition, a USB stick, ...). Before installing from it, a flat apt
+// repository is generated under ~/.cache/shadowmite/local-repo: Packages and
+// Release indexes plus symlinks to the .debs, rebuilt only when the directory's files
+// change. apt then reads only these repositories, through a private
+// sources.list and lists directory, so no network is touched.
+static fs::path local_repo_root() {
+    return cache_dir_path() / "local-repo";
+}
+
+static fs::path local_repo_dir(const std::string& repo) {
+    char name[32];
+    snprintf(name, sizeof(name), "%016zx", std::hash<std::string>{}(repo));
+    return local_repo_root() / name;
+}
+
+static std::string sha256_file(const fs::path& path) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return "";
+    GChecksum* sum = g_checksum_new(G_CHECKSUM_SHA256);
+    std::vector<guchar> buf(1 << 16);
+    ssize_t n;
+    while ((n = read(fd, buf.data(), buf.size())) > 0) g_checksum_update(sum, buf.data(), n);
+    close(fd);
+    std::string hex = n == 0 ? g_checksum_get_string(sum) : "";
+    g_checksum_free(sum);
+    return hex;
+}
+
+// Control fields of a .deb, as `dpkg-deb -f` prints them
+static std::string deb_control(const fs::path& deb) {
+    gchar* argv[] = { (gchar*)"dpkg-deb", (gchar*)"-f", (gchar*)deb.c_str(), NULL };
+    gchar* out = NULL;
+    gint status = 0;
+    std::string control;
+    if (g_spawn_sync(NULL, argv, NULL, (GSpawnFlags)(G_SPAWN_SEARCH_PATH | G_SPAWN_STDERR_TO_DEV_NULL),
+                     NULL, NULL, &out, NULL, &status, NULL) && g_spawn_check_exit_status(status, NULL) && out) {
+        control = out;
+    }
+    g_free(out);
+    while (!control.empty() && control.back() == '\n') control.pop_back();
+    return control;
+}
+
+// Generate (or reuse) the flat repository for `repo`; false if it has no .debs
+static bool index_local_repo(const std::string& repo) {
+    std::vector<std::pair<fs::path, FileStamp>> debs;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(repo, ec)) {
+        if (entry.path().extension() != ".deb") continue;
+        FileStamp stamp;
+        if (stamp_file(entry.path(), stamp)) debs.emplace_back(entry.path(), stamp);
+    }
+    if (debs.empty()) {
+        g_print("No .deb files in local repository %s\n", repo.c_str());
+        return false;
+    }
+    std::sort(debs.begin(), debs.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    std::string stamps;
+    for (const auto& d : debs) {
+        stamps += d.first.string() + " " + std::to_string(d.second.mtime_ns) + " " +
+                  std::to_string(d.second.size) + " " + std::to_string(d.second.inode) + "\n";
+    }
+    fs::path dir = local_repo_dir(repo);
+    std::ifstream old(dir / "stamps");
+    std::string old_stamps((std::istreambuf_iterator<char>(old)), std::istreambuf_iterator<char>());
+    if (old_stamps == stamps && fs::exists(dir / "Packages")) return true;
+
+    fs::remove_all(dir, ec);
+    fs::create_directories(dir, ec);
+    std::string packages;
+    // Only what was indexed is stamped, so a skipped .deb is retried next time
+    std::string indexed;
+    size_t n = 0;
+    for (const auto& d : debs) {
+        std::string control = deb_control(d.first);
+        std::string sha = control.empty() ? "" : sha256_file(d.first);
+        if (sha.empty()) {
+            g_print("Skipping unreadable package %s\n", d.first.c_str());
+            continue;
+        }
+        indexed += d.first.string() + " " + std::to_string(d.second.mtime_ns) + " " +
+                   std::to_string(d.second.size) + " " + std::to_string(d.second.inode) + "\n";
+        // Unique link names: two directories may hold equally named files
+        std::string link = std::to_string(n++) + "_" + d.first.filename().string();
+        fs::create_symlink(d.first, dir / link, ec);
+        packages += control + "\nFilename: ./" + link + "\nSize: " + std::to_string(d.second.size) +
+                    "\nSHA256: " + sha + "\n\n";
+    }
+    // An unsigned Release (the source is marked trusted=yes); a fixed Date
+    // keeps apt from warning about a missing one
+    GChecksum* sum = g_checksum_new(G_CHECKSUM_SHA256);
+    g_checksum_update(sum, (const guchar*)packages.data(), packages.size());
+    std::string release = "Origin: shadowmite\nLabel: shadowmite local\nDate: Thu, 01 Jan 1970 00:00:00 UTC\nSHA256:\n " +
+                          std::string(g_checksum_get_string(sum)) + " " + std::to_string(packages.size()) + " Packages\n";
+    g_checksum_free(sum);
+    return write_file_atomic(dir / "Packages", packages, false) && write_file_atomic(dir / "Release", release, false) &&
+           write_file_atomic(dir / "stamps", indexed, false);
+}
+
+// "a (>= 1) | b:any, c" -> {{"a", "b"}, {"c"}}; also reads Provides.
+// Version constraints are dropped.
+static std::vector<std::vector<std::string>> parse_depends(std::string_view field) {
+    std::vector<std::vector<std::string>> groups;
+    std::vector<std::string> alts;
+    std::string name;
+    bool in_version = false;
+    auto end_alt = [&]() {
+        if (!name.empty()) alts.push_back(bare_package_name(name));
+        name.clear();
+    };
+    auto end_group = [&]() {
+        end_alt();
+        if (!alts.empty()) groups.push_back(std::move(alts));
+        alts.clear();
+    };
+    for (char c : field) {
+        if (in_version) in_version = c != ')';
+        else if (c == '(') in_version = true;
+        else if (c == '|') end_alt();
+        else if (c == ',') end_group();
+        else if (!isspace((unsigned char)c)) name += c;
+    }
+    end_group();
+    return groups;
+}
+
+// Dependencies of `wanted` that neither the generated repositories nor the
+// installed system provide. The offline step sees only the local lists, so
+// apt would fail on these with a far less helpful message. Versions are not
+// compared; apt still has the last word.
+static std::vector<std::string> local_repo_missing_deps(const std::vector<std::string>& repos,
+                                                        const std::vector<std::string>& wanted) {
+    std::unordered_map<std::string, std::string> local_deps;    // package -> Depends, Pre-Depends
+    std::unordered_map<std::string, std::string> local_provides;    // virtual name -> a local provider
+    static const char* const repo_fields[] = {"Package", "Depends", "Pre-Depends", "Provides"};
+    for (const auto& repo : repos) {
+        fs::path packages = local_repo_dir(repo) / "Packages";
+        scan_control_path(packages.c_str(), repo_fields, [&](const std::array<std::string_view, 4>& f) {
+            if (f[0].empty()) return;
+            local_deps[std::string(f[0])] = std::string(f[1]) + "," + std::string(f[2]);
+            for (const auto& group : parse_depends(f[3]))
+                for (const auto& name : group) local_provides.emplace(name, std::string(f[0]));
+        });
+    }
+    std::unordered_set<std::string> installed;
+    static const char* const status_fields[] = {"Package", "Status", "Provides"};
+    scan_control_path(DPKG_STATUS, status_fields, [&](const std::array<std::string_view, 3>& f) {
+        if (f[0].empty() || !status_installed(f[1])) return;
+        installed.insert(std::string(f[0]));
+        for (const auto& group : parse_depends(f[2])) installed.insert(group.begin(), group.end());
+    });
+
+    std::vector<std::string> missing;
+    std::unordered_set<std::string> seen;
+    std::vector<std::string> todo;
+    for (const auto& name : wanted) {
+        std::string bare = bare_package_name(name);
+        auto provider = local_provides.find(bare);
+        if (local_deps.count(bare)) todo.push_back(bare);
+        else if (installed.count(bare)) continue;
+        else if (provider != local_provides.end()) todo.push_back(provider->second);
+        else missing.push_back(bare);
+    }
+    while (!todo.empty()) {
+        std::string pkg = std::move(todo.back());
+        todo.pop_back();
+        if (!seen.insert(pkg).second) continue;
+        for (const auto& group : parse_depends(local_deps[pkg])) {
+            const std::string* local = nullptr;
+            bool ok = false;
+            for (const auto& alt : group) {
+                if (installed.count(alt)) ok = true;
+                if (local) continue;
+                auto provider = local_provides.find(alt);
+                if (local_deps.count(alt)) local = &alt;
+                else if (provider != local_provides.end()) local = &provider->second;
+            }
+            if (ok) continue;
+            if (local) {
+                todo.push_back(*local);
+                continue;
+            }
+            std::string text;
+            for (const auto& alt : group) text += (text.empty() ? "" : " | ") + alt;
+            if (std::find(missing.begin(), missing.end(), text) == missing.end()) missing.push_back(text);
+        }
+    }
+    return missing;
+}
+
+// apt options that confine a run to the generated repositories
+static std::vector<std::string> local_repo_apt_options() {
+    fs::path root = local_repo_root();
+    return {
+        "-o", "Dir::Etc::SourceList=" + (root / "sources.list").string(),
+        "-o", "Dir::Etc::SourceParts=" + (root / "sources.list.d").string(),
+        "-o", "Dir::State::Lists=" + (root / "lists").string(),
+        "-o", "Acquire::Languages=none",
+    };
+}
+
+static bool write_local_sources(const std::vector<std::string>& repos) {
+    fs::path root = local_repo_root();
+    std::error_code ec;
+    fs::create_directories(root / "sources.list.d", ec);
+    fs::create_directories(root / "lists" / "partial", ec);
+    std::string list;
+    for (const auto& repo : repos) list += "deb [trusted=yes] file:" + local_repo_dir(repo).string() + " ./\n";
+    return write_file_atomic(root / "sources.list", list, false);
+}
+
+// ---------------- Package installation (async) ----------------
+// apt-get runs as a child process watched from the main loop. Its
+// APT::Status-Fd lines (dlstatus:/pmstatus:/pmerror:) drive the summary
+// page's progress bar; the regular output is discarded. Status goes to
+// stderr because sudo closes any other inherited descriptor.
+struct InstallExit {
+    AppWidgets* aw;
+    guint serial;
+};
+
+struct LocalRepoBuild {
+    AppWidgets* aw;
+    guint serial;
+    std::vector<std::string> repos;
+    std::vector<std::string> packages;      // installed from `repos`
+    bool ok;
+    std::vector<std::string> missing;       // dependencies found nowhere
+};
+
+static void install_update_ui(AppWidgets* aw) {
+    if (!aw->install_progress) return;
+    InstallJob& job = aw->install;
+    // Includes a cancel that hasn't exited yet and an install queued behind a prefetch
+    bool running = job.pid > 0 || job.preparing || aw->prefetch.install_pending;
+    gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(aw->install_progress), job.fraction);
+    gtk_label_set_text(GTK_LABEL(aw->install_action), job.action.c_str());
+    gtk_widget_set_visible(aw->install_progress, job.state != InstallState::Idle);
+    gtk_widget_set_sensitive(aw->install_cancel_btn, job.state == InstallState::Running || aw->prefetch.install_pending);
+    gtk_widget_set_sensitive(aw->summary_install_btn, !running);
+    if (aw->apps_install_btn) gtk_widget_set_sensitive(aw->apps_install_btn, !running && !aw->apps_checked.empty());
+}
+
+// Progress within the running step, scaled to the whole install
+static void install_set_step_fraction(InstallJob& job, double fraction) {
+    size_t n = std::max<size_t>(job.steps.size(), 1);
+    job.fraction = (job.step + std::min(fraction, 1.0)) / n;
+}
+
+// Close the timing record of the current download/unpack/configure phase
+static void install_phase_end(AppWidgets* aw, const std::string& status, int exit_code = -1) {
+    InstallJob& job = aw->install;
+    if (job.phase.empty()) return;
+    const std::string& label = job.step < job.steps.size() ? job.steps[job.step].label : "";
+    timing_record(aw, "install_" + job.phase, label, job.phase_started, g_get_monotonic_time(), status, exit_code);
+    job.phase.clear();
+}
+
+static void install_set_phase(AppWidgets* aw, const char* phase) {
+    InstallJob& job = aw->install;
+    if (job.phase == phase) return;
+    install_phase_end(aw, "ok");
+    job.phase = phase;
+    job.phase_started = g_get_monotonic_time();
+}
+
+// Child exit: closes the phase and times the whole step
+static void install_step_end(AppWidgets* aw, gint status) {
+    InstallJob& job = aw->install;
+    bool cancelled = job.state == InstallState::Cancelled;
+    int code = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    const char* result = cancelled ? "cancelled" : code == 0 ? "ok" : "failed";
+    install_phase_end(aw, result, code);
+    if (job.step < job.steps.size())
+        timing_record(aw, "install_step", job.steps[job.step].label, job.step_started, g_get_monotonic_time(), result, code);
+}
+
+// "pmstatus:<pkg>:<percent>:<message>", "dlstatus:<item>:<percent>:<message>".
+// The package may itself contain a colon (multiarch), so the percent is the
+// first purely numeric field after the first one.
+static void install_status_line(AppWidgets* aw, const std::string& line) {
+    InstallJob& job = aw->install;
+    size_t colon = line.find(':');
+    if (colon == std::string::npos) return;
+    std::string tag = line.substr(0, colon);
+    if (tag != "dlstatus" && tag != "pmstatus" && tag != "pmerror") {
+        g_print("apt-get: %s\n", line.c_str());
+        return;
+    }
+
+    size_t pos = line.find(':', colon + 1);
+    if (pos == std::string::npos) return;
+    ++pos;
+    while (pos < line.size()) {
+        size_t end = line.find(':', pos);
+        if (end == std::string::npos) break;
+        std::string field = line.substr(pos, end - pos);
+        char* num_end = nullptr;
+        double percent = field.empty() ? 0 : strtod(field.c_str(), &num_end);
+        if (!field.empty() && *num_end == '\0') {
+            std::string message = line.substr(end + 1);
+            if (tag == "pmerror") {
+                g_print("apt-get error: %s\n", message.c_str());
+                return;
+            }
+            if (tag == "dlstatus") {
+                job.saw_download = true;
+                install_set_phase(aw, "download");
+                install_set_step_fraction(job, percent / 200);
+            } else {
+                // "Preparing to configure", "Configuring", "Installed" vs "Preparing", "Unpacking"
+                bool configure = message.find("onfigur") != std::string::npos || message.rfind("Installed", 0) == 0;
+                install_set_phase(aw, configure ? "configure" : "unpack");
+                install_set_step_fraction(job, job.saw_download ? 0.5 + percent / 200 : percent / 100);
+            }
+            // The label needs UTF-8; the channel hands over raw bytes
+            gchar* valid = g_utf8_make_valid(message.c_str(), message.size());
+            job.action = valid;
+            g_free(valid);
+            install_update_ui(aw);
+            return;
+        }
+        pos = end + 1;
+    }
+}
+
+// Handle every complete line buffered in the channel; returns the status
+// that stopped the loop (AGAIN, EOF or ERROR)
+static GIOStatus install_drain_status(AppWidgets* aw, GIOChannel* channel) {
+    gchar* line = NULL;
+    gsize len = 0;
+    GIOStatus st;
+    while ((st = g_io_channel_read_line(channel, &line, &len, NULL, NULL)) == G_IO_STATUS_NORMAL) {
+        std::string text(line, len);
+        g_free(line);
+        while (!text.empty() && (text.back() == '\n' || text.back() == '\r')) text.pop_back();
+        install_status_line(aw, text);
+    }
+    return st;
+}
+
+static gboolean install_status_cb(GIOChannel* channel, GIOCondition cond, gpointer data) {
+    AppWidgets* aw = (AppWidgets*)data;
+    GIOStatus st = install_drain_status(aw, channel);
+    // Keep reading past a failed read until the pipe is closed: apt-get
+    // blocks once the pipe fills up
+    if (st == G_IO_STATUS_AGAIN) return G_SOURCE_CONTINUE;
+    if (st == G_IO_STATUS_ERROR && !(cond & (G_IO_HUP | G_IO_ERR))) return G_SOURCE_CONTINUE;
+    // EOF; the child watch finishes the step
+    aw->install.status_watch = 0;
+    return G_SOURCE_REMOVE;
+}
+
+static void install_close_status(InstallJob& job) {
+    if (job.status_watch) g_source_remove(job.status_watch);
+    job.status_watch = 0;
+    if (job.status) g_io_channel_unref(job.status);
+    job.status = NULL;
+}
+
+// `reason` replaces the generic failure text when known
+static void install_finish(AppWidgets* aw, InstallState state, const std::string& reason = "") {
+    InstallJob& job = aw->install;
+    job.state = state;
+    job.preparing = false;
+    if (state == InstallState::Done) {
+        job.fraction = 1.0;
+        job.action = "Installation complete";
+    } else if (state == InstallState::Cancelled) {
+        job.action = "Installation cancelled";
+    } else {
+        g_print("Install failed at step \"%s\" for %zu package(s)\n",
+                job.step < job.steps.size() ? job.steps[job.step].label.c_str() : "", job.packages.size());
+        job.action = reason.empty() ? "Installation failed" : "Installation failed: " + reason;
+    }
+    install_update_ui(aw);
+    journal_end(aw, job.journal_step, state == InstallState::Done ? JournalState::Done :
+                                      state == InstallState::Cancelled ? JournalState::Cancelled : JournalState::Failed);
+    refresh_installed_badges(aw);
+    // Apps picked while apt was busy
+    prefetch_start(aw);
+    // A failed or cancelled resume still goes on to the remaining steps
+    if (aw->journal_resuming) journal_resume_next(aw);
+}
+
+static void install_exited(GPid pid, gint status, gpointer user_data);
+
+static void install_run_step(AppWidgets* aw) {
+    InstallJob& job = aw->install;
+    if (job.step >= job.steps.size()) {
+        install_finish(aw, InstallState::Done);
+        return;
+    }
+    const InstallStep& step = job.steps[job.step];
+    std::vector<gchar*> argv;
+    for (const auto& arg : step.argv) argv.push_back((gchar*)arg.c_str());
+    argv.push_back(NULL);
+
+    GError* err = NULL;
+    GPid pid = 0;
+    gint err_fd = -1;
+    job.step_started = g_get_monotonic_time();
+    if (!g_spawn_async_with_pipes(NULL, argv.data(), NULL,
+                                  (GSpawnFlags)(G_SPAWN_SEARCH_PATH | G_SPAWN_DO_NOT_REAP_CHILD | G_SPAWN_STDOUT_TO_DEV_NULL),
+                                  NULL, NULL, &pid, NULL, NULL, &err_fd, &err)) {
+        g_print("Failed to start apt-get: %s\n", err->message);
+        g_error_free(err);
+        timing_record(aw, "install_step", step.label, job.step_started, g_get_monotonic_time(), "failed");
+        install_finish(aw, InstallState::Failed);
+        return;
+    }
+
+    job.pid = pid;
+    job.phase.clear();
+    job.saw_download = false;
+    job.action = step.label;
+    install_set_step_fraction(job, 0);
+    job.status = g_io_channel_unix_new(err_fd);
+    g_io_channel_set_close_on_unref(job.status, TRUE);
+    // Raw bytes: localized dpkg messages need not be UTF-8
+    g_io_channel_set_encoding(job.status, NULL, NULL);
+    g_io_channel_set_flags(job.status, G_IO_FLAG_NONBLOCK, NULL);
+    job.status_watch = g_io_add_watch(job.status, (GIOCondition)(G_IO_IN | G_IO_HUP | G_IO_ERR), install_status_cb, aw);
+    g_child_watch_add(pid, install_exited, new InstallExit{aw, job.serial});
+    install_update_ui(aw);
+}
+
+static void install_exited(GPid pid, gint status, gpointer user_data) {
+    InstallExit* ex = (InstallExit*)user_data;
+    AppWidgets* aw = ex->aw;
+    bool stale = ex->serial != aw->install.serial;
+    g_spawn_close_pid(pid);
+    delete ex;
+    if (stale) return;
+
+    InstallJob& job = aw->install;
+    // Pick up whatever status lines were still buffered
+    if (job.status) install_drain_status(aw, job.status);
+    install_close_status(job);
+    job.pid = 0;
+    install_step_end(aw, status);
+    if (job.state == InstallState::Cancelled) {
+        install_finish(aw, InstallState::Cancelled);
+    } else if (g_spawn_check_exit_status(status, NULL)) {
+        job.step++;
+        install_run_step(aw);
+    } else {
+        install_finish(aw, InstallState::Failed);
+    }
+}
+
+static void local_repo_thread(LocalRepoBuild* build) {
+    gint64 start = g_get_monotonic_time();
+    build->ok = !build->repos.empty();
+    for (const auto& repo : build->repos) build->ok = index_local_repo(repo) && build->ok;
+    build->ok = build->ok && write_local_sources(build->repos);
+    if (build->ok) build->missing = local_repo_missing_deps(build->repos, build->packages);
+    timing_record(build->aw, "local_repo_index", std::to_string(build->repos.size()) + " repo(s)",
+                  start, g_get_monotonic_time(), build->ok ? "ok" : "failed");
+    g_idle_add((GSourceFunc)[](gpointer arg)->gboolean {
+        LocalRepoBuild* build = (LocalRepoBuild*)arg;
+        AppWidgets* aw = build->aw;
+        bool stale = build->serial != aw->install.serial;
+        bool ok = build->ok;
+        std::string missing;
+        for (const auto& dep : build->missing) missing += (missing.empty() ? "" : ", ") + dep;
+        delete build;
+        if (stale) return G_SOURCE_REMOVE;
+
+        InstallJob& job = aw->install;
+        job.preparing = false;
+        if (job.state == InstallState::Cancelled) {
+            install_finish(aw, InstallState::Cancelled);
+        } else if (!ok) {
+            install_finish(aw, InstallState::Failed);
+        } else if (!missing.empty()) {
+            g_print("Not in the local packages or installed: %s\n", missing.c_str());
+            install_finish(aw, InstallState::Failed, "missing " + missing);
+        } else {
+            install_run_step(aw);
+        }
+        return G_SOURCE_REMOVE;
+    }, build);
+}
+
+// Install every package in as few apt transactions as possible, so
+// dependency resolution, downloads and dpkg configuration happen once for the
+// whole set: one transaction for apps with a local repository (offline) and
+// one for the rest. `repair_dpkg` first finishes an interrupted dpkg run.
+// False if nothing was started or queued (busy, or no package names).
+static bool install_packages(AppWidgets* aw, const std::vector<InstallItem>& items, bool repair_dpkg = false) {
+    InstallJob& job = aw->install;
+    if (job.pid > 0 || job.preparing || aw->prefetch.install_pending) return false;
+
+    std::vector<std::string> online, offline, repos;
+    for (const auto& item : items) (item.repo.empty() ? online : offline).push_back(item.package);
+    for (const auto& item : items) {
+        if (!item.repo.empty() && std::find(repos.begin(), repos.end(), item.repo) == repos.end())
+            repos.push_back(item.repo);
+    }
+    online = split_package_names(online);
+    offline = split_package_names(offline);
+    if (online.empty() && offline.empty()) return false;
+    job.journal_step = journal_begin(aw, "install", "", items);
+
+    // A prefetch holds the apt cache lock; queue behind it rather than kill
+    // it, so the packages it is fetching don't have to be downloaded again
+    if (aw->prefetch.pid > 0) {
+        aw->prefetch.install_pending = true;
+        aw->prefetch.pending_items = items;
+        aw->prefetch.pending_repair = repair_dpkg;
+        job.state = InstallState::Running;
+        job.fraction = 0;
+        job.action = "Waiting for downloads to finish\u2026";
+        install_update_ui(aw);
+        return true;
+    }
+
+    // Nobody can answer a debconf or conffile prompt from here: take defaults
+    // and keep locally modified conffiles
+    std::vector<std::string> install = {"sudo", "env", "DEBIAN_FRONTEND=noninteractive",
+                                        "apt-get", "install", "-y", "-o", "APT::Status-Fd=2",
+                                        "-o", "Dpkg::Options::=--force-confdef", "-o", "Dpkg::Options::=--force-confold"};
+    job.serial++;
+    job.steps.clear();
+    job.packages.clear();
+    if (repair_dpkg) {
+        job.steps.push_back({"Repairing interrupted install\u2026",
+                             {"sudo", "env", "DEBIAN_FRONTEND=noninteractive", "dpkg", "--configure", "-a",
+                              "--force-confdef", "--force-confold"}});
+    }
+    if (!offline.empty()) {
+        std::vector<std::string> opts = local_repo_apt_options();
+        std::vector<std::string> update = {"sudo", "apt-get", "update", "-o", "APT::Status-Fd=2"};
+        update.insert(update.end(), opts.begin(), opts.end());
+        std::vector<std::string> argv = install;
+        argv.insert(argv.end(), opts.begin(), opts.end());
+        argv.push_back("--");
+        argv.insert(argv.end(), offline.begin(), offline.end());
+        job.steps.push_back({"Reading local packages\u2026", std::move(update)});
+        job.steps.push_back({"Installing from local packages\u2026", std::move(argv)});
+        job.packages.insert(job.packages.end(), offline.begin(), offline.end());
+    }
+    if (!online.empty()) {
+        std::vector<std::string> argv = install;
+        argv.push_back("--");
+        argv.insert(argv.end(), online.begin(), online.end());
+        job.steps.push_back({"Preparing\u2026", std::move(argv)});
+        job.packages.insert(job.packages.end(), online.begin(), online.end());
+    }
+    job.step = 0;
+    job.state = InstallState::Running;
+    job.fraction = 0;
+
+    if (repos.empty()) {
+        install_run_step(aw);
+        return true;
+    }
+    job.preparing = true;
+    job.action = "Indexing local packages\u2026";
+    install_update_ui(aw);
+    std::thread(local_repo_thread, new LocalRepoBuild{aw, job.serial, std::move(repos), offline, false, {}}).detach();
+    return true;
+}
+
+// apt-get (via sudo) stops on SIGTERM and dpkg finishes the current unpack
+static void install_cancel(AppWidgets* aw) {
+    InstallJob& job = aw->install;
+    if (aw->prefetch.install_pending) {
+        aw->prefetch.install_pending = false;
+        aw->prefetch.pending_items.clear();
+        install_finish(aw, InstallState::Cancelled);
+        return;
+    }
+    if (job.state != InstallState::Running) return;
+    job.state = InstallState::Cancelled;
+    job.action = "Cancelling\u2026";
+    // While indexing there's no child yet; the worker's completion finishes the job
+    if (job.pid > 0) kill(job.pid, SIGTERM);
+    install_update_ui(aw);
+}
+
+// ---------------- Package prefetch ----------------
+// Opening an app's summary or ticking it starts `apt-get --download-only`
+// for everything picked so far; the .debs stay in the apt cache, so the
+// real install only unpacks and configures. Runs are never killed: picks
+// made meanwhile are fetched by a follow-up run once the current one exits.
+// Each run only gets the names not fetched yet, minus those the apt lists
+// don't know, so one bad name can't fail every later run.
+
+static void prefetch_exited(GPid pid, gint status, gpointer user_data) {
+    AppWidgets* aw = (AppWidgets*)user_data;
+    g_spawn_close_pid(pid);
+    PrefetchJob& pf = aw->prefetch;
+    pf.pid = 0;
+    // A failed run (e.g. an unknown package) isn't retried; the install reports it
+    if (!g_spawn_check_exit_status(status, NULL)) g_print("Package pre-download failed\n");
+    pf.covered = pf.in_flight;
+
+    if (pf.install_pending) {
+        pf.install_pending = false;
+        std::vector<InstallItem> items = std::move(pf.pending_items);
+        pf.pending_items.clear();
+        install_packages(aw, items, pf.pending_repair);
+        return;
+    }
+    prefetch_start(aw);
+}
+
+static void prefetch_start(AppWidgets* aw) {
+    PrefetchJob& pf = aw->prefetch;
+    if (pf.pid > 0 || aw->install.pid > 0 || aw->install.preparing || pf.covered >= pf.wanted.size()) return;
+
+    std::vector<gchar*> argv = { (gchar*)"sudo", (gchar*)"apt-get", (gchar*)"install", (gchar*)"--download-only",
+                                 (gchar*)"-y", (gchar*)"-q", (gchar*)"--" };
+    const AptListsIndex& idx = aw->apt_lists;
+    size_t base = argv.size();
+    for (size_t i = pf.covered; i < pf.wanted.size(); ++i) {
+        const std::string& name = pf.wanted[i];
+        if (idx.loaded && !idx.packages.empty() && !idx.packages.count(bare_package_name(name))) continue;
+        argv.push_back((gchar*)name.c_str());
+    }
+    if (argv.size() == base) {
+        pf.covered = pf.wanted.size();
+        return;
+    }
+    argv.push_back(NULL);
+
+    GError* err = NULL;
+    GPid pid = 0;
+    if (!g_spawn_async(NULL, argv.data(), NULL,
+                       (GSpawnFlags)(G_SPAWN_SEARCH_PATH | G_SPAWN_DO_NOT_REAP_CHILD |
+                                     G_SPAWN_STDOUT_TO_DEV_NULL | G_SPAWN_STDERR_TO_DEV_NULL),
+                       NULL, NULL, &pid, &err)) {
+        g_print("Failed to start package pre-download: %s\n", err->message);
+        g_error_free(err);
+        pf.covered = pf.wanted.size();
+        return;
+    }
+    pf.pid = pid;
+    pf.in_flight = pf.wanted.size();
+    g_child_watch_add(pid, prefetch_exited, aw);
+}
+
+static void prefetch_request(AppWidgets* aw, const std::string& package_field) {
+    PrefetchJob& pf = aw->prefetch;
+    for (auto& name : split_package_names({package_field})) {
+        if (pf.known.insert(name).second) pf.wanted.push_back(std::move(name));
+    }
+    prefetch_start(aw);
+}
+
+// An app was unticked: drop its names unless another ticked app needs them
+static void prefetch_forget(AppWidgets* aw, const std::string& package_field) {
+    PrefetchJob& pf = aw->prefetch;
+    std::unordered_set<std::string> still_needed;
+    for (const auto& path : aw->apps_checked) {
+        int64_t id = catalog_find(aw->catalog, path);
+        if (id < 0) continue;
+        for (auto& name : split_package_names({catalog_str(aw->catalog, aw->catalog.entries[id].package)}))
+            still_needed.insert(std::move(name));
+    }
+    for (const auto& name : split_package_names({package_field})) {
+        if (still_needed.count(name) || !pf.known.erase(name)) continue;
+        auto it = std::find(pf.wanted.begin(), pf.wanted.end(), name);
+        if (it == pf.wanted.end()) continue;
+        size_t i = it - pf.wanted.begin();
+        pf.wanted.erase(it);
+        if (i < pf.covered) pf.covered--;
+        if (i < pf.in_flight) pf.in_flight--;
+    }
 }
 
 // ---------------- Prescribed Apps + Summary ----------------
+// Version, sizes and availability of the selected package, from the apt
+// lists index. The index is built on a worker the first time a summary is
+// shown and rebuilt only when a list file changed (e.g. after apt update).
+struct AptListsLoad {
+    AppWidgets* aw;
+    std::vector<std::pair<std::string, FileStamp>> lists;
+    std::unordered_map<std::string, AptPackageInfo> packages;
+};
+
+static void update_summary_package_info(AppWidgets* aw) {
+    if (!aw->summary_pkg_info) return;
+    std::vector<std::string> names = split_package_names({aw->selected_package});
+    if (names.empty()) {
+        gtk_label_set_text(GTK_LABEL(aw->summary_pkg_info), "");
+        return;
+    }
+    if (!aw->selected_repo.empty()) {
+        std::string text = "Installs offline from " + aw->selected_repo;
+        gtk_label_set_text(GTK_LABEL(aw->summary_pkg_info), text.c_str());
+        return;
+    }
+    const AptListsIndex& idx = aw->apt_lists;
+    if (!idx.loaded) {
+        gtk_label_set_text(GTK_LABEL(aw->summary_pkg_info), "Checking package lists\u2026");
+        return;
+    }
+    if (idx.packages.empty()) {
+        gtk_label_set_text(GTK_LABEL(aw->summary_pkg_info), "Package lists are not available (run apt update).");
+        return;
+    }
+
+    uint64_t download = 0, installed_kb = 0;
+    std::string missing;
+    const AptPackageInfo* single = nullptr;
+    for (const auto& name : names) {
+        auto it = idx.packages.find(bare_package_name(name));
+        if (it == idx.packages.end()) {
+            if (!missing.empty()) missing += ", ";
+            missing += name;
+            continue;
+        }
+        single = &it->second;
+        download += it->second.size;
+        installed_kb += it->second.installed_size_kb;
+    }
+
+    gchar* markup;
+    if (!missing.empty()) {
+        markup = g_markup_printf_escaped("<span foreground='#c01c28'>Not found in the package lists: %s</span>",
+                                         missing.c_str());
+    } else {
+        gchar* dl = g_format_size(download);
+        gchar* inst = g_format_size(installed_kb * 1024);
+        std::string version = names.size() == 1 ? "Version " + single->version + "  \u00b7  "
+                                                 : std::to_string(names.size()) + " packages  \u00b7  ";
+        markup = g_markup_printf_escaped("%sDownload %s  \u00b7  Installed size %s", version.c_str(), dl, inst);
+        g_free(dl);
+        g_free(inst);
+    }
+    gtk_label_set_markup(GTK_LABEL(aw->summary_pkg_info), markup);
+    g_free(markup);
+}
+
+static void apt_lists_thread(AptListsLoad* load) {
+    for (const auto& list : load->lists) read_apt_list(list.first, load->packages);
+    g_idle_add((GSourceFunc)[](gpointer arg)->gboolean {
+        AptListsLoad* load = (AptListsLoad*)arg;
+        AptListsIndex& idx = load->aw->apt_lists;
+        idx.lists = std::move(load->lists);
+        idx.packages = std::move(load->packages);
+        idx.loaded = true;
+        idx.building = false;
+        update_summary_package_info(load->aw);
+        delete load;
+        return G_SOURCE_REMOVE;
+    }, load);
+}
+
+static void apt_lists_refresh(AppWidgets* aw) {
+    AptListsIndex& idx = aw->apt_lists;
+    if (idx.building) return;
+    auto lists = apt_lists_signature();
+    if (idx.loaded && lists == idx.lists) return;
+    idx.building = true;
+    std::thread(apt_lists_thread, new AptListsLoad{aw, std::move(lists), {}}).detach();
+}
+
 void show_summary(AppWidgets* aw, const std::string& name, const std::string& description,
                   const std::string& logo, const std::string& package, const fs::path& json_path) {
+    ensure_page(aw, "summary");
     aw->selected_package = package;
     aw->selected_json_path = json_path;
-
-    if (aw->summary_logo && fs::exists(logo)) gtk_image_set_from_file(GTK_IMAGE(aw->summary_logo), logo.c_str());
+    int64_t id = json_path.empty() ? -1 : catalog_find(aw->catalog, json_path.string());
+    aw->selected_repo = id >= 0 ? catalog_str(aw->catalog, aw->catalog.entries[id].repo) : "";
+    // Offline apps come from their local repository; nothing to download
+    if (!package.empty() && aw->selected_repo.empty()) prefetch_request(aw, package);
+
+    if (GdkPixbuf* pixbuf = load_logo_thumbnail(logo, LOGO_SUMMARY_SIZE)) {
+        gtk_image_set_from_pixbuf(GTK_IMAGE(aw->summary_logo), pixbuf);
+        g_object_unref(pixbuf);
+    }
     gtk_label_set_text(GTK_LABEL(aw->summary_name), name.c_str());
     gtk_label_set_text(GTK_LABEL(aw->summary_desc), description.c_str());
+    apt_lists_refresh(aw);
+    update_summary_package_info(aw);
     gtk_widget_show_all(aw->summary_box);
-    gtk_stack_set_visible_child_name(GTK_STACK(aw->stack), "summary");
+    // A batch (or a resumed install) has no single app to edit or install
+    gtk_widget_set_visible(aw->summary_edit_btn, !json_path.empty());
+    gtk_widget_set_visible(aw->summary_install_btn, !package.empty());
+    show_page(aw, "summary");
 }
 
 static void edit_json_btn_clicked(GtkButton* button, gpointer data) {
@@ -588,13 +4009,90 @@ static void edit_json_btn_clicked(GtkButton* button, gpointer data) {
 static void install_btn_clicked(GtkButton* button, gpointer data) {
     AppWidgets* aw = (AppWidgets*)data;
     if (aw->selected_package.empty()) return;
-    std::string cmd = "sudo apt install -y " + aw->selected_package;
-    system(cmd.c_str());
+    install_packages(aw, {{aw->selected_package, aw->selected_repo}});
+}
+
+// The batch is shown on the summary page, which carries the progress bar
+static void install_selected_clicked(GtkButton* button, gpointer data) {
+    AppWidgets* aw = (AppWidgets*)data;
+    std::vector<InstallItem> items;
+    std::string names;
+    for (const auto& path : aw->apps_checked) {
+        int64_t id = catalog_find(aw->catalog, path);
+        if (id < 0) continue;
+        const CatalogEntry& e = aw->catalog.entries[id];
+        items.push_back({catalog_str(aw->catalog, e.package), catalog_str(aw->catalog, e.repo)});
+        if (!names.empty()) names += ", ";
+        names += catalog_str(aw->catalog, e.name);
+    }
+    if (items.empty()) return;
+    show_summary(aw, std::to_string(items.size()) + " apps selected", names,
+                 (apps_dir_path() / "logos/default.png").string(), "", "");
+    install_packages(aw, items);
+}
+
+// Resume the journal after a crash: incomplete installs first, one at a
+// time, then the finish page for a locale or timezone whose apply had begun.
+// Choices that were only made (pending) reopen the locale page with them
+// preselected, so the network and apps pages aren't skipped. Completed
+// steps are not repeated; an install that can't be started (or fails) is
+// marked failed and the rest still run.
+static void journal_resume_next(AppWidgets* aw) {
+    for (size_t i = 0; i < aw->journal.size(); ++i) {
+        const JournalStep& step = aw->journal[i];
+        if (step.kind != "install" || !journal_incomplete(step)) continue;
+        std::vector<InstallItem> items = step.items;
+        std::string names;
+        for (const auto& item : items) names += (names.empty() ? "" : ", ") + item.package;
+        show_summary(aw, "Resuming installation", names, (apps_dir_path() / "logos/default.png").string(), "", "");
+        if (install_packages(aw, items, dpkg_interrupted())) return;
+        g_print("Cannot resume install of %s\n", names.c_str());
+        journal_end(aw, (int)i, JournalState::Failed);
+    }
+    aw->journal_resuming = false;
+    bool pending = false;
+    for (const auto& step : aw->journal) {
+        if (step.kind == "install") continue;
+        if (step.state == JournalState::Running) {
+            show_page(aw, "finish");
+            return;
+        }
+        pending = pending || step.state == JournalState::Pending;
+    }
+    if (pending) show_page(aw, "locale");
+}
+
+// False when there is nothing to resume and the wizard starts normally
+static bool journal_resume(AppWidgets* aw) {
+    journal_load(aw);
+    bool incomplete = false;
+    for (const auto& step : aw->journal) {
+        if (!journal_incomplete(step)) continue;
+        incomplete = true;
+        if (step.kind == "locale") {
+            aw->selected_lang = step.target;
+            aw->lang_chosen = true;
+        }
+        if (step.kind == "timezone") {
+            aw->selected_tz = step.target;
+            aw->tz_chosen = true;
+        }
+    }
+    if (!incomplete) {
+        // A finished run; the next one starts a fresh journal
+        aw->journal.clear();
+        std::error_code ec;
+        fs::remove(journal_path(), ec);
+        return false;
+    }
+    aw->journal_resuming = true;
+    journal_resume_next(aw);
+    return true;
 }
 
 static void summary_back_clicked(GtkButton* button, gpointer data) {
     AppWidgets* aw = (AppWidgets*)data;
-    gtk_stack_set_visible_child_name(GTK_STACK(aw->stack), "apps");
+    show_page(aw, "apps");
 }
 
 void setup_summary_screen(AppWidgets* aw) {
@@ -616,21 +4114,40 @@ void setup_summary_screen(AppWidgets* aw) {
     gtk_box_pack_start(GTK_BOX(aw->summary_box), aw->summary_name, FALSE, FALSE, 4);
     gtk_box_pack_start(GTK_BOX(aw->summary_box), aw->summary_desc, FALSE, FALSE, 4);
 
+    aw->summary_pkg_info = gtk_label_new("");
+    gtk_widget_set_name(aw->summary_pkg_info, "summary-pkg-info");
+    gtk_box_pack_start(GTK_BOX(aw->summary_box), aw->summary_pkg_info, FALSE, FALSE, 4);
+
+    // --- Install progress (hidden until an install starts) ---
+    aw->install_progress = gtk_progress_bar_new();
+    gtk_widget_set_no_show_all(aw->install_progress, TRUE);
+    aw->install_action = gtk_label_new("");
+    gtk_label_set_ellipsize(GTK_LABEL(aw->install_action), PANGO_ELLIPSIZE_END);
+    gtk_box_pack_start(GTK_BOX(aw->summary_box), aw->install_progress, FALSE, FALSE, 4);
+    gtk_box_pack_start(GTK_BOX(aw->summary_box), aw->install_action, FALSE, FALSE, 4);
+
     GtkWidget* btn_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 10);
-    GtkWidget* edit_btn = gtk_button_new_with_label("Edit JSON");
-    GtkWidget* install_btn = gtk_button_new_with_label("Install");
+    aw->summary_edit_btn = gtk_button_new_with_label("Edit JSON");
+    GtkWidget* edit_btn = aw->summary_edit_btn;
+    aw->summary_install_btn = gtk_button_new_with_label("Install");
+    aw->install_cancel_btn = gtk_button_new_with_label("Cancel");
     GtkWidget* back_btn = gtk_button_new_with_label("Back");
 
     g_signal_connect(edit_btn, "clicked", G_CALLBACK(edit_json_btn_clicked), aw);
-    g_signal_connect(install_btn, "clicked", G_CALLBACK(install_btn_clicked), aw);
+    g_signal_connect(aw->summary_install_btn, "clicked", G_CALLBACK(install_btn_clicked), aw);
+    g_signal_connect(aw->install_cancel_btn, "clicked", G_CALLBACK(+[](GtkButton*, gpointer data){
+        install_cancel((AppWidgets*)data);
+    }), aw);
     g_signal_connect(back_btn, "clicked", G_CALLBACK(summary_back_clicked), aw);
 
     gtk_box_pack_start(GTK_BOX(btn_box), edit_btn, FALSE, FALSE, 0);
-    gtk_box_pack_start(GTK_BOX(btn_box), install_btn, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(btn_box), aw->summary_install_btn, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(btn_box), aw->install_cancel_btn, FALSE, FALSE, 0);
     gtk_box_pack_start(GTK_BOX(btn_box), back_btn, FALSE, FALSE, 0);
 
     gtk_box_pack_end(GTK_BOX(aw->summary_box), btn_box, FALSE, FALSE, 6);
     gtk_stack_add_named(GTK_STACK(aw->stack), aw->summary_box, "summary");
+    install_update_ui(aw);
 }
 
 void setup_apps_screen(AppWidgets* aw) {
@@ -646,10 +4163,15 @@ void setup_apps_screen(AppWidgets* aw) {
     gtk_box_pack_start(GTK_BOX(vbox), title, FALSE, FALSE, 5);
 
     // --- Subtitle / explanatory text under header ---
-    GtkWidget* subtitle = gtk_label_new("Select an app, create a new one, or reload the list.");
+    GtkWidget* subtitle = gtk_label_new("Select an app, tick several to install them together, or create a new one.");
     gtk_widget_set_halign(subtitle, GTK_ALIGN_CENTER);
     gtk_box_pack_start(GTK_BOX(vbox), subtitle, FALSE, FALSE, 10);
 
+    aw->apps_search = gtk_search_entry_new();
+    gtk_entry_set_placeholder_text(GTK_ENTRY(aw->apps_search), "Search name, description or package");
+    g_signal_connect(aw->apps_search, "search-changed", G_CALLBACK(apps_search_changed_cb), aw);
+    gtk_box_pack_start(GTK_BOX(vbox), aw->apps_search, FALSE, FALSE, 0);
+
     // --- Scrollable apps list inside a frame (thin border) ---
     GtkWidget* apps_frame = gtk_frame_new(NULL);
     gtk_container_set_border_width(GTK_CONTAINER(apps_frame), 6);
@@ -657,10 +4179,53 @@ void setup_apps_screen(AppWidgets* aw) {
     aw->apps_scrolled = gtk_scrolled_window_new(NULL, NULL);
     gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(aw->apps_scrolled),
                                    GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
-
-    aw->apps_list_box = gtk_box_new(GTK_ORIENTATION_VERTICAL, 8);
-    gtk_container_set_border_width(GTK_CONTAINER(aw->apps_list_box), 12);
-    gtk_container_add(GTK_CONTAINER(aw->apps_scrolled), aw->apps_list_box);
+    g_signal_connect_swapped(gtk_scrolled_window_get_vadjustment(GTK_SCROLLED_WINDOW(aw->apps_scrolled)),
+                             "value-changed", G_CALLBACK(logo_prioritize_schedule), aw);
+
+    // Sorting happens in the store; the view only renders what is on screen
+    aw->apps_store = gtk_list_store_new(APP_N_COLS, G_TYPE_BOOLEAN, GDK_TYPE_PIXBUF, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_UINT);
+    gtk_tree_sortable_set_sort_column_id(GTK_TREE_SORTABLE(aw->apps_store), APP_COL_NAME, GTK_SORT_ASCENDING);
+    aw->apps_filter = gtk_tree_model_filter_new(GTK_TREE_MODEL(aw->apps_store), NULL);
+    gtk_tree_model_filter_set_visible_func(GTK_TREE_MODEL_FILTER(aw->apps_filter), app_row_visible, aw, NULL);
+    aw->apps_view = gtk_tree_view_new_with_model(aw->apps_filter);
+    gtk_tree_view_set_headers_visible(GTK_TREE_VIEW(aw->apps_view), FALSE);
+    gtk_tree_view_set_enable_search(GTK_TREE_VIEW(aw->apps_view), FALSE);
+    gtk_tree_view_set_activate_on_single_click(GTK_TREE_VIEW(aw->apps_view), TRUE);
+
+    GtkCellRenderer* check_renderer = gtk_cell_renderer_toggle_new();
+    g_signal_connect(check_renderer, "toggled", G_CALLBACK(app_toggled_cb), aw);
+    GtkTreeViewColumn* check_col = gtk_tree_view_column_new_with_attributes(
+        "", check_renderer, "active", APP_COL_CHECKED, NULL);
+    gtk_tree_view_column_set_sizing(check_col, GTK_TREE_VIEW_COLUMN_FIXED);
+    gtk_tree_view_column_set_fixed_width(check_col, 36);
+    gtk_tree_view_append_column(GTK_TREE_VIEW(aw->apps_view), check_col);
+
+    GtkCellRenderer* logo_renderer = gtk_cell_renderer_pixbuf_new();
+    gtk_cell_renderer_set_fixed_size(logo_renderer, LOGO_LIST_SIZE + 20, LOGO_LIST_SIZE + 16);
+    GtkTreeViewColumn* logo_col = gtk_tree_view_column_new_with_attributes(
+        "Logo", logo_renderer, "pixbuf", APP_COL_LOGO, NULL);
+    gtk_tree_view_column_set_sizing(logo_col, GTK_TREE_VIEW_COLUMN_FIXED);
+    gtk_tree_view_column_set_fixed_width(logo_col, LOGO_LIST_SIZE + 20);
+    gtk_tree_view_append_column(GTK_TREE_VIEW(aw->apps_view), logo_col);
+
+    GtkCellRenderer* text_renderer = gtk_cell_renderer_text_new();
+    g_object_set(text_renderer, "ellipsize", PANGO_ELLIPSIZE_END, NULL);
+    GtkTreeViewColumn* text_col = gtk_tree_view_column_new_with_attributes(
+        "App", text_renderer, "markup", APP_COL_TEXT, NULL);
+    gtk_tree_view_column_set_sizing(text_col, GTK_TREE_VIEW_COLUMN_FIXED);
+    gtk_tree_view_column_set_expand(text_col, TRUE);
+    gtk_tree_view_append_column(GTK_TREE_VIEW(aw->apps_view), text_col);
+
+    GtkCellRenderer* cont_renderer = gtk_cell_renderer_text_new();
+    g_object_set(cont_renderer, "text", "Continue \u203a", "xpad", 10, NULL);
+    GtkTreeViewColumn* cont_col = gtk_tree_view_column_new_with_attributes("", cont_renderer, NULL);
+    gtk_tree_view_column_set_sizing(cont_col, GTK_TREE_VIEW_COLUMN_FIXED);
+    gtk_tree_view_column_set_fixed_width(cont_col, 110);
+    gtk_tree_view_append_column(GTK_TREE_VIEW(aw->apps_view), cont_col);
+
+    gtk_tree_view_set_fixed_height_mode(GTK_TREE_VIEW(aw->apps_view), TRUE);
+    g_signal_connect(aw->apps_view, "row-activated", G_CALLBACK(app_row_activated_cb), aw);
+    gtk_container_add(GTK_CONTAINER(aw->apps_scrolled), aw->apps_view);
     gtk_container_add(GTK_CONTAINER(apps_frame), aw->apps_scrolled);
     gtk_box_pack_start(GTK_BOX(vbox), apps_frame, TRUE, TRUE, 10);
 
@@ -671,7 +4236,7 @@ void setup_apps_screen(AppWidgets* aw) {
     GtkWidget* back_btn = gtk_button_new_with_label("Back");
     g_signal_connect(back_btn, "clicked", G_CALLBACK(+[](GtkButton*, gpointer data){
         AppWidgets* aw = (AppWidgets*)data;
-        gtk_stack_set_visible_child_name(GTK_STACK(aw->stack), "locale");
+        show_page(aw, "locale");
     }), aw);
 
     GtkWidget* reload_btn = gtk_button_new_with_label("Reload");
@@ -681,8 +4246,7 @@ void setup_apps_screen(AppWidgets* aw) {
 
     GtkWidget* create_btn = gtk_button_new_with_label("Create");
     g_signal_connect(create_btn, "clicked", G_CALLBACK(+[](GtkButton* btn, gpointer data){
-        AppWidgets* aw = (AppWidgets*)data;
-        fs::path apps_dir = fs::path(getenv("HOME")) / "sm_conf" / "apps";
+        fs::path apps_dir = apps_dir_path();
         if (!fs::exists(apps_dir)) fs::create_directories(apps_dir);
         // unique filename with timestamp to avoid clobbering
         auto t = std::chrono::system_clock::now();
@@ -700,22 +4264,25 @@ void setup_apps_screen(AppWidgets* aw) {
         ofs.close();
 
         // Open in nano inside user's terminal emulator immediately
+        // (the directory monitor adds the new row)
         std::string cmd = "x-terminal-emulator -e \"nano '" + new_json.string() + "'\" &";
         system(cmd.c_str());
-
-        // Refresh the list
-        reload_prescribed_apps(aw);
     }), aw);
 
     GtkWidget* skip_btn = gtk_button_new_with_label("Skip");
     g_signal_connect(skip_btn, "clicked", G_CALLBACK(+[](GtkButton*, gpointer data){
         AppWidgets* aw = (AppWidgets*)data;
-        gtk_stack_set_visible_child_name(GTK_STACK(aw->stack), "finish");
+        show_page(aw, "finish");
     }), aw);
 
     gtk_box_pack_start(GTK_BOX(button_box), back_btn, FALSE, FALSE, 0);
     gtk_box_pack_start(GTK_BOX(button_box), reload_btn, FALSE, FALSE, 0);
+    aw->apps_install_btn = gtk_button_new_with_label("Install selected");
+    g_signal_connect(aw->apps_install_btn, "clicked", G_CALLBACK(install_selected_clicked), aw);
+    apps_update_install_button(aw);
+
     gtk_box_pack_start(GTK_BOX(button_box), create_btn, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(button_box), aw->apps_install_btn, FALSE, FALSE, 0);
     gtk_box_pack_start(GTK_BOX(button_box), skip_btn, FALSE, FALSE, 0);
 
     gtk_box_pack_start(GTK_BOX(vbox), button_box, FALSE, FALSE, 10);
@@ -724,9 +4291,6 @@ void setup_apps_screen(AppWidgets* aw) {
     aw->status_label = gtk_label_new("");
     gtk_widget_set_halign(aw->status_label, GTK_ALIGN_CENTER);
     gtk_box_pack_start(GTK_BOX(vbox), aw->status_label, FALSE, FALSE, 5);
-
-    // --- Summary setup (hidden until used) ---
-    setup_summary_screen(aw);
 }
 
 // ---------------- Setup Finish screen ----------------
@@ -780,24 +4344,20 @@ void setup_finish_screen(AppWidgets* aw) {
         AppWidgets* aw = (AppWidgets*)data;
         const char* child = gtk_stack_get_visible_child_name(GTK_STACK(aw->stack));
         if (child && strcmp(child, "finish") == 0) {
-            // find the labels inside the finish page and update them
-            // simple approach: iterate children of stack's finish page and set text
-            GtkWidget* finish_page = nullptr;
-            GList* kids = gtk_container_get_children(GTK_CONTAINER(aw->stack));
-            for (GList* it = kids; it; it = it->next) {
-                GtkWidget* w = GTK_WIDGET(it->data);
-                const char* name = gtk_widget_get_name(w);
-                // not relying on names: find the "finish" page by pointer comparison
-                if (gtk_widget_get_visible(w) && GTK_IS_BOX(w)) {
-                    // but safer: skip — instead directly rebuild summary labels here:
-                }
-            }
-            g_list_free(kids);
             // update a new temporary summary printout in stdout (and status_label) so user sees values
             std::string s = "Iface: " + aw->selected_iface + "  Wi-Fi: " + (aw->selected_wifi.empty() ? std::string("None") : aw->selected_wifi)
                 + "  Lang: " + aw->selected_lang + "  TZ: " + aw->selected_tz;
             g_print("%s\n", s.c_str());
             if (aw->status_label) gtk_label_set_text(GTK_LABEL(aw->status_label), s.c_str());
+
+            locale_apply(aw);
+            timezone_apply(aw);
+            // Steps still running (locale, installs) rewrite the report as they finish
+            {
+                std::lock_guard<std::mutex> lock(aw->timings.mu);
+                aw->timings.report_enabled = true;
+            }
+            timing_write_report(aw);
         }
     }), aw);
 
@@ -834,17 +4394,14 @@ int main(int argc, char** argv) {
     aw->stack = GTK_WIDGET(gtk_stack_new());
     gtk_container_add(GTK_CONTAINER(aw->window), aw->stack);
 
-    setup_welcome_screen(aw);
-    setup_network_screen(aw);
-    setup_locale_screen(aw);
-    setup_apps_screen(aw);
-    setup_finish_screen(aw);
+    aw->timings.origin = g_get_monotonic_time();
+    start_locale_enumeration(aw);
 
-    gtk_stack_set_visible_child_name(GTK_STACK(aw->stack), "welcome");
+    // Remaining pages (and the app catalog) are built on first navigation.
+    // An interrupted run picks up where the journal says it stopped.
+    if (!journal_resume(aw)) show_page(aw, "welcome");
     gtk_widget_show_all(aw->window);
 
-    load_prescribed_apps(aw);
-
     gtk_main();
     return 0;
 }